@@ -0,0 +1,158 @@
+/** \file bench.cpp
+ * \brief func_bench: a machine-readable regression benchmark suite.
+ *
+ * Sweeps table type x degree x uniform/nonuniform x table size (working sets
+ * sized for L1/L2/LLC/DRAM residency) with LookupTableComparator and emits
+ * one json document with enough metadata (compiler, CPU, date) to diff runs.
+ *
+ * Usage:
+ *   func_bench out.json                      # run the sweep, write results
+ *   func_bench out.json baseline.json [pct]  # also fail (exit 1) if any mean
+ *                                            # regressed more than pct% (default 10)
+ *
+ * Wire the second form into acceptance testing to catch performance
+ * regressions when bumping compilers or FunC versions.
+ */
+#include "func.hpp"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <ctime>
+#include <string>
+#include <vector>
+
+template <typename T>
+T f_bench(T x){ return x*sin(x); }
+
+#define TYPE double
+#define MIN_ARG 0.5
+#define MAX_ARG 10.0
+
+using namespace func;
+
+int main(int argc, char* argv[])
+{
+  if(argc < 2){
+    std::cerr << "usage: func_bench out.json [baseline.json [tolerance_pct]]" << std::endl;
+    return 2;
+  }
+  const std::string out_filename = argv[1];
+  const std::string baseline_filename = argc > 2 ? argv[2] : "";
+  const double tolerance_pct = argc > 3 ? std::atof(argv[3]) : 10.0;
+
+  FunctionContainer<TYPE> fc{FUNC_SET_F(f_bench,TYPE)};
+  LookupTableGenerator<TYPE> gen(fc, MIN_ARG, MAX_ARG);
+
+  /* table types to sweep. Types whose construction throws (eg. Chebyshev
+   * without Armadillo) are skipped with a note */
+  std::vector<std::string> tableKeys = {
+    "UniformExactInterpTable<1>",
+    "UniformExactInterpTable<3>",
+    "UniformExactInterpTable<5>",
+    "NonUniformExactInterpTable<3>",
+    "UniformTaylorTable<3>",
+    "UniformChebyInterpTable<3>",
+  };
+
+  /* target coefficient-array bytes: resident in L1 / L2 / LLC / DRAM */
+  std::vector<std::pair<std::string,std::size_t>> working_sets = {
+    {"L1",   16u*1024u},
+    {"L2",  256u*1024u},
+    {"LLC",   8u*1024u*1024u},
+    {"DRAM", 64u*1024u*1024u},
+  };
+
+  nlohmann::json out;
+  out["_comment"] = "FunC benchmark results (mean seconds per pass of nEvals evaluations)";
+  out["meta"]["compiler"] = __VERSION__;
+  out["meta"]["func_version"] = "2.1";
+  {
+    std::time_t t = std::time(nullptr);
+    char buf[64];
+    std::strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S", std::gmtime(&t));
+    out["meta"]["date"] = buf;
+  }
+  {
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while(std::getline(cpuinfo, line))
+      if(line.compare(0, 10, "model name") == 0){
+        out["meta"]["cpu"] = line.substr(line.find(':')+2);
+        break;
+      }
+  }
+  const unsigned int nEvals = 100000;
+  const int nRuns = 5;
+  out["meta"]["nEvals"] = nEvals;
+  out["meta"]["nRuns"] = nRuns;
+
+  for(auto& ws : working_sets){
+    ImplContainer<TYPE,TYPE> impls;
+    for(auto& key : tableKeys){
+      /* pick the step so this type's coefficient array is ~ws.second bytes.
+       * bytes ~= (numIntervals+1)*sizeof(entry); probe with a tiny table */
+      try{
+        auto probe = gen.generate_by_step(key, (MAX_ARG-MIN_ARG)/16.0);
+        double bytes_per_interval = probe->size()/static_cast<double>(probe->num_subintervals());
+        double nIntervals = ws.second/bytes_per_interval;
+        impls.push_back(gen.generate_by_step(key, (MAX_ARG-MIN_ARG)/nIntervals));
+      }catch(std::exception& e){
+        if(out["skipped"].find(key) == out["skipped"].end())
+          out["skipped"][key] = e.what();
+      }
+    }
+    if(impls.empty()) continue;
+
+    LookupTableComparator<TYPE> comparator(impls, MIN_ARG, MAX_ARG, nEvals);
+    comparator.run_timings(nRuns);
+    comparator.compute_statistics();
+
+    /* pull {name: {min,max,mean}} out of the comparator's json */
+    std::ostringstream ss;
+    comparator.print_json(ss);
+    nlohmann::json stats = nlohmann::json::parse(ss.str());
+    for(auto it = stats.begin(); it != stats.end(); ++it){
+      if(!it.value().is_object() || !it.value().contains("mean")) continue;
+      out["results"][ws.first][it.key()]["mean"] = it.value()["mean"];
+      out["results"][ws.first][it.key()]["min"]  = it.value()["min"];
+      out["results"][ws.first][it.key()]["max"]  = it.value()["max"];
+    }
+  }
+
+  std::ofstream(out_filename) << out.dump(2) << std::endl;
+  std::cout << "wrote " << out_filename << std::endl;
+
+  /* compare against a baseline and fail on regressions */
+  if(baseline_filename != ""){
+    nlohmann::json base;
+    std::ifstream ifs(baseline_filename);
+    if(!ifs){
+      std::cerr << "func_bench: cannot open baseline " << baseline_filename << std::endl;
+      return 2;
+    }
+    ifs >> base;
+
+    int regressions = 0;
+    for(auto ws = out["results"].begin(); ws != out["results"].end(); ++ws){
+      if(base["results"].find(ws.key()) == base["results"].end()) continue;
+      for(auto impl = ws.value().begin(); impl != ws.value().end(); ++impl){
+        auto& bws = base["results"][ws.key()];
+        if(bws.find(impl.key()) == bws.end()) continue;
+        double now = impl.value()["mean"].get<double>();
+        double ref = bws[impl.key()]["mean"].get<double>();
+        if(now > ref*(1.0 + tolerance_pct/100.0)){
+          std::cerr << "REGRESSION: " << ws.key() << " " << impl.key() << ": "
+                    << ref << "s -> " << now << "s (+" << 100.0*(now-ref)/ref << "%)" << std::endl;
+          regressions++;
+        }
+      }
+    }
+    if(regressions){
+      std::cerr << regressions << " benchmark(s) regressed more than " << tolerance_pct << "%" << std::endl;
+      return 1;
+    }
+    std::cout << "no regression beyond " << tolerance_pct << "%" << std::endl;
+  }
+  return 0;
+}
@@ -66,9 +66,9 @@ int main(int argc, char* argv[]){
     //"UniformChebyInterpTable<6>",
     //"UniformChebyInterpTable<7>",
     //"UniformCubicHermiteTable",
-    "UniformEqSpaceInterpTable<1>",
-    "UniformEqSpaceInterpTable<2>",
-    "UniformEqSpaceInterpTable<3>",
+    "UniformExactInterpTable<1>",
+    "UniformExactInterpTable<2>",
+    "UniformExactInterpTable<3>",
     //"UniformLinearRawInterpTable",
     //"UniformTaylorTable<1>",
     //"UniformTaylorTable<2>",
@@ -88,9 +88,9 @@ int main(int argc, char* argv[]){
     //"NonUniformChebyInterpTable<6>",
     //"NonUniformChebyInterpTable<7>",
     //"NonUniformCubicHermiteTable",
-    "NonUniformEqSpaceInterpTable<1>",
-    "NonUniformEqSpaceInterpTable<2>",
-    "NonUniformEqSpaceInterpTable<3>",
+    "NonUniformExactInterpTable<1>",
+    "NonUniformExactInterpTable<2>",
+    "NonUniformExactInterpTable<3>",
     //"NonUniformTaylorTable<1>",
     //"NonUniformTaylorTable<2>",
     //"NonUniformTaylorTable<3>",
@@ -44,6 +44,38 @@ int main()
   std::cout << gen.error_of_table(F) << std::endl;
   std::cout << gen.error_of_table(C) << std::endl;
 
+  /* Batch evaluation must agree with one-at-a-time evaluation */
+  UniformExactInterpTable<3,TYPE> L(func_container, {MIN_ARG,MAX_ARG,STEP});
+  std::vector<TYPE> xs(NEVALS), ys(NEVALS);
+  for(unsigned int i=0; i<NEVALS; i++)
+    xs[i] = MIN_ARG + (MAX_ARG-MIN_ARG)*i/static_cast<TYPE>(NEVALS);
+  L.eval(xs.data(), ys.data(), xs.size());
+  /* tolerate a few ulps in case the vectorized kernel contracts FMAs differently */
+  for(unsigned int i=0; i<NEVALS; i++)
+    if(std::abs(ys[i] - L(xs[i])) > 8*std::numeric_limits<TYPE>::epsilon()*std::abs(ys[i]))
+      throw std::logic_error("LookupTable::eval disagrees with LookupTable::operator()");
+  std::cout << "L.eval matches L.operator()" << std::endl;
+
+  /* a failed generation through TableCache must release its file lock:
+   * the retry below would deadlock on this process's own stale flock */
+  {
+    auto& cache = TableCache<TYPE>::instance();
+    LookupTableGenerator<TYPE> cgen(func_container, MIN_ARG, MAX_ARG);
+    try {
+      cache.get_by_step(cgen, "NoSuchTable<9>", STEP, "test_interfaces_cache.json");
+      throw std::logic_error("TableCache accepted an unregistered table name");
+    } catch(std::invalid_argument&) { /* expected */ }
+    auto L2 = cache.get_by_step(cgen, "UniformExactInterpTable<3>", STEP, "test_interfaces_cache.json");
+    std::cout << "TableCache recovered after a failed generation: L2(1) = " << (*L2)(1) << std::endl;
+  }
+
+  /* the SoA-layout batch kernel must agree with the AoS one */
+  L.eval<StorageLayout::SOA>(xs.data(), ys.data(), xs.size());
+  for(unsigned int i=0; i<NEVALS; i++)
+    if(std::abs(ys[i] - L(xs[i])) > 8*std::numeric_limits<TYPE>::epsilon()*std::abs(ys[i]))
+      throw std::logic_error("LookupTable::eval<SOA> disagrees with LookupTable::operator()");
+  std::cout << "L.eval<SOA> matches L.operator()" << std::endl;
+
   // TODO 
   ///* copy the above objects into unique_ptrs so we can use a LookupTableComparator */
   //std::vector<std::unique_ptr<LookupTable<TYPE>>> impls;
@@ -5,6 +5,7 @@
 #pragma once
 #include <stdexcept>
 #include <functional>
+#include <utility> // declval (make_function_container)
 #include "config.hpp" // FUNC_USE_BOOST
 
 #ifdef FUNC_USE_BOOST
@@ -165,4 +166,33 @@ public:
 #endif // FUNC_USE_BOOST
 };
 
+/** \brief A FunctionContainer that also keeps the callable's concrete type.
+ *
+ * FunctionContainer erases f behind std::function, so every sample during
+ * table construction or error estimation pays an indirect call and the
+ * sampling loops cannot inline or vectorize through it. This subclass still
+ * fills the std::function members (so it drops into every existing API:
+ * tables, generator, factory) but additionally exposes the unerased callable
+ * as raw_fun for code that is templated on the container type (eg.
+ * make_direct_evaluation). The factory/registry itself cannot propagate F --
+ * its registry is type-erased by design -- so raw_fun only speeds up callers
+ * that keep the concrete container type visible. */
+template <typename F, typename TIN, typename TOUT = TIN>
+class StaticFunctionContainer : public FunctionContainer<TIN,TOUT>
+{
+public:
+  F raw_fun; //!< the unerased callable; calls through this can inline
+
+  StaticFunctionContainer(F f) : FunctionContainer<TIN,TOUT>(f), raw_fun(f) {}
+};
+
+/** \brief Deduce a StaticFunctionContainer from a callable.
+ *
+ * eg. auto fc = func::make_function_container<double>([](double x){ return x*x; }); */
+template <typename TIN, typename F>
+StaticFunctionContainer<F,TIN,decltype(std::declval<F>()(std::declval<TIN>()))>
+make_function_container(F f){
+  return StaticFunctionContainer<F,TIN,decltype(std::declval<F>()(std::declval<TIN>()))>(f);
+}
+
 } // namespace func
@@ -3,6 +3,10 @@
 #include <stdexcept>
 #include <functional>
 #include <ostream> // operator<<
+#include <sstream> // to_string
+#include <cstddef> // size_t
+#include <vector> // special_points, usage_histogram
+#include <tuple> // special_points
 #include "FunctionContainer.hpp"
 
 namespace func {
@@ -19,6 +23,14 @@ struct LookupTableParameters
   /// special_points (roots, critical points, inflection points)
   std::vector<std::tuple<TIN,unsigned,TOUT>> special_points;
 
+  /// observed-usage histogram (eg. ArgumentRecord::histogram()) over
+  /// [usage_min,usage_max]. When nonempty, nonuniform tables build their
+  /// transfer function from where the caller actually evaluates instead of
+  /// from the function's derivative.
+  std::vector<unsigned int> usage_histogram;
+  TIN usage_min = TIN();
+  TIN usage_max = TIN();
+
   LookupTableParameters(TIN min, TIN max, TIN step, std::vector<std::tuple<TIN,unsigned,TOUT>> pts) :
     minArg(min), maxArg(max), stepSize(step), special_points(pts) {}
   LookupTableParameters(TIN min, TIN max, TIN step) :
@@ -26,6 +38,18 @@ struct LookupTableParameters
   LookupTableParameters(){}
 };
 
+/** \brief Lightweight always-on telemetry for the wrapper tables
+ * (FailureProofTable, DirectEvaluation).
+ *
+ * Unlike the FUNC_DEBUG histograms these counters are compiled in by default:
+ * they cost one relaxed atomic increment per evaluation, which is how we can
+ * know in production which of hundreds of tables are actually hot and how
+ * often a FailureProofTable falls back to its slow std::function path. */
+struct EvalStats {
+  unsigned long long total_evals = 0;
+  unsigned long long out_of_domain_evals = 0; //!< evaluations that fell outside the wrapped LUT's bounds
+};
+
 /**
   \brief Abstract interface for representing an approximation to a user provided mathematical function.
 
@@ -51,6 +75,16 @@ public:
   virtual TOUT operator()(TIN x) const = 0;
   //virtual TOUT diff(unsigned int N, TIN x) = 0;
 
+  /** \brief Evaluate the LUT at each of the n points in xs, writing results to out.
+   *
+   * This default implementation just loops over operator() so every
+   * implementation supports batch evaluation. Implementations that can do
+   * better (eg. MetaTable's vectorized hash+Horner kernel) override this. */
+  virtual void eval(const TIN* xs, TOUT* out, std::size_t n) const {
+    for(std::size_t i=0; i<n; i++)
+      out[i] = (*this)(xs[i]);
+  }
+
   /* public interface for access to protected data */
   virtual std::string name() const = 0;
   virtual TIN min_arg() const = 0;
@@ -101,9 +101,22 @@ public:
     }
 
     /* Allocate and set table */
-    m_table.reset(new polynomial<TOUT,N+1>[m_numTableEntries]);
+    allocate_table(m_numTableEntries);
+
+    /* The nondimensionalized node matrix Van is identical for every
+     * subinterval, so instead of one small arma::solve (an O(N^3)
+     * factorization plus several arma::vec allocations) per interval we
+     * gather every interval's samples into one (N+1) x numIntervals matrix
+     * and solve all right hand sides in a single batched call: Van is
+     * factored once and the backsolves run as one GEMM-shaped operation.
+     * Intervals containing user-supplied exact points still take the
+     * per-interval path below since their Vandermonde matrix differs. */
+    arma::mat Y(N+1, m_numTableEntries-1, arma::fill::zeros); // zero so special-point columns hold benign values
     FUNC_BUILDPAR
     for(unsigned int ii=0;ii<m_numTableEntries-1;++ii) {
+      if(d_intervals.find(ii) != d_intervals.end())
+        continue; // this interval's samples are gathered in the special-point path
+
       double x;
       double h = static_cast<double>(m_stepSize);
       // (possibly) transform the uniform grid into a nonuniform grid
@@ -116,16 +129,34 @@ public:
 
       // Chebyshev nodes over [x,x+h]:
       arma::vec xvec = x + h*(1.0 + arma::cos( arma::datum::pi*(2*arma::linspace(1,N+1,N+1)-1)/(2*(N+1)) ))/2.0;
+      for (unsigned int k=0; k<N+1; k++)
+        Y(k,ii) = static_cast<double>(fun(static_cast<TIN>(xvec[k])));
+    }
+    /* solve for every interval's coefficients at once
+     * (solve_opts strictly waste time with cheby nodes) */
+    arma::mat C = arma::solve(Van, Y);
+
+    FUNC_BUILDPAR
+    for(unsigned int ii=0;ii<m_numTableEntries-1;++ii) {
+      double x;
+      double h = static_cast<double>(m_stepSize);
+      FUNC_IF_CONSTEXPR(GT == GridTypes::UNIFORM)
+        x = static_cast<double>(m_minArg + ii*m_stepSize);
+      else{
+        x = static_cast<double>(m_transferFunction(m_minArg + ii*m_stepSize));
+        h = static_cast<double>(m_transferFunction(m_minArg + (ii+1)*m_stepSize) - x);
+      }
+
       // y will contain our desired coefficients after the following if statement
       arma::vec y(N+1);
 
       /* check if this subinterval contain any points the user wants _exact_ */
       auto iter = d_intervals.find(ii);
       if(iter == d_intervals.end()){
-        for (unsigned int k=0; k<N+1; k++)
-          y[k] = static_cast<double>(fun(static_cast<TIN>(xvec[k])));
-        y = arma::solve(Van,y); /* solve_opts strictly waste time with cheby nodes */
+        y = C.col(ii);
       }else{
+        // Chebyshev nodes over [x,x+h]:
+        arma::vec xvec = x + h*(1.0 + arma::cos( arma::datum::pi*(2*arma::linspace(1,N+1,N+1)-1)/(2*(N+1)) ))/2.0;
         /* replace each nearest chebyshev node in this interval with the user's nodes.*/
         arma::vec  xvec2 = xvec;
         arma::Col<unsigned> svec(N+1);
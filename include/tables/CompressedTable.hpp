@@ -0,0 +1,116 @@
+/** \file CompressedTable.hpp
+ * \brief Store a LUT's coefficients in a compact type decoupled from TOUT.
+ * \ingroup MetaTable
+ *
+ * polynomial<TOUT,N> stores coefficients at full TOUT precision, but a table
+ * that only needs 1e-6 accuracy wastes half its memory bandwidth keeping
+ * doubles. CompressedTable copies a built MetaTable's coefficients into
+ * TSTORE (float by default) and widens back to TOUT during the Horner
+ * evaluation, halving the footprint so twice as many tables stay resident
+ * in the last-level cache.
+ *
+ * Usage example:
+ * \code{.cpp}
+ *   UniformChebyInterpTable<3,double> L(fc, par);
+ *   CompressedTable<decltype(L)> C(L);           // float storage
+ *   LookupTableGenerator<double> gen(fc, a, b);
+ *   double err = gen.error_of_table(C);          // validate the demoted table
+ * \endcode
+ *
+ * Notes:
+ * - Implements the LookupTable interface, so error_of_table and the
+ *   comparator work on it unchanged -- always validate that the demoted
+ *   table still meets your tolerance.
+ * - The hash (uniform or transfer-function) stays in full TIN precision;
+ *   only coefficient storage is demoted.
+ * - Nonuniform tables lose noticeably more accuracy than uniform ones when
+ *   demoted: their polynomials act on absolute (not nondimensionalized)
+ *   arguments, so rounding the large alternating-sign coefficients to TSTORE
+ *   is amplified by cancellation. error_of_table tells you if that matters.
+ */
+#pragma once
+#include "MetaTable.hpp"
+#include <memory>
+#include <string>
+
+namespace func {
+
+template <class LUT_TYPE, typename TSTORE = float>
+class CompressedTable final : public LookupTable<typename LUT_TYPE::input_type, typename LUT_TYPE::output_type>
+{
+public:
+  using input_type = typename LUT_TYPE::input_type;
+  using output_type = typename LUT_TYPE::output_type;
+
+private:
+  using TIN = input_type;
+  using TOUT = output_type;
+  static constexpr unsigned int N = LUT_TYPE::num_coefs;
+
+  std::string m_name;
+  TIN m_minArg, m_maxArg, m_stepSize, m_stepSize_inv, m_tableMaxArg;
+  unsigned int m_order, m_numIntervals, m_numTableEntries;
+  TransferFunction<TIN> m_transferFunction;
+  bool m_nonuniform;
+  std::unique_ptr<TSTORE[]> m_coefs; //!< flat [interval*N + coef], demoted to TSTORE
+
+public:
+  CompressedTable(const LUT_TYPE& lut) :
+    m_name("Compressed<" + lut.name() + ">"),
+    m_minArg(lut.min_arg()), m_maxArg(lut.max_arg()),
+    m_stepSize(lut.step_size()), m_stepSize_inv(static_cast<TIN>(1.0)/lut.step_size()),
+    m_tableMaxArg(lut.tablemax_arg()), m_order(lut.order()),
+    m_numIntervals(lut.num_subintervals()), m_numTableEntries(lut.num_table_entries()),
+    m_transferFunction(lut.transfer_function_coefs())
+  {
+    auto tf = lut.transfer_function_coefs();
+    m_nonuniform = tf[0] != TIN(0) || tf[1] != TIN(0) || tf[2] != TIN(0) || tf[3] != TIN(0);
+    m_coefs.reset(new TSTORE[static_cast<std::size_t>(m_numTableEntries)*N]);
+    for(unsigned int i=0; i<m_numTableEntries; i++)
+      for(unsigned int j=0; j<N; j++)
+        m_coefs[static_cast<std::size_t>(i)*N + j] = static_cast<TSTORE>(lut.table_entry(i,j));
+  }
+
+  /** \brief the usual hash + Horner, widening each TSTORE coefficient to TOUT */
+  TOUT operator()(TIN x) const final {
+    unsigned int x0; TIN dx;
+    if(!m_nonuniform){
+      dx = m_stepSize_inv*(x-m_minArg);
+      x0 = static_cast<unsigned int>(dx);
+      dx -= x0;
+    }else{
+      x0 = static_cast<unsigned int>(m_transferFunction.inverse(x));
+      dx = x;
+    }
+
+    const TSTORE* c = m_coefs.get() + static_cast<std::size_t>(x0)*N;
+    TOUT sum = static_cast<TOUT>(c[N-1]);
+    for(unsigned int k=N-1; k>0; k--){
+      sum *= dx;
+      sum += static_cast<TOUT>(c[k-1]);
+    }
+    return sum;
+  }
+
+  std::string name() const final { return m_name; }
+  TIN min_arg() const final { return m_minArg; }
+  TIN max_arg() const final { return m_maxArg; }
+  unsigned int order() const final { return m_order; }
+  std::size_t size() const final { return static_cast<std::size_t>(m_numTableEntries)*N*sizeof(TSTORE); }
+  unsigned int num_subintervals() const final { return m_numIntervals; }
+  TIN step_size() const final { return m_stepSize; }
+  std::pair<TIN,TIN> bounds_of_subinterval(unsigned int intervalNumber) const final {
+    /* same logic as MetaTable::bounds_of_subinterval */
+    TIN intervalMin = m_minArg + intervalNumber*m_stepSize;
+    TIN intervalMax = m_minArg + (intervalNumber+1)*m_stepSize;
+    if(m_nonuniform){
+      intervalMin = m_transferFunction(intervalMin);
+      intervalMax = m_transferFunction(intervalMax);
+    }
+    if(intervalMax > m_maxArg) intervalMax = m_maxArg;
+    return std::make_pair(intervalMin,intervalMax);
+  }
+  void print_json(std::ostream& out) const final { (void) out; /* TODO compressed tables are built from a full-precision source; serialize that instead */ }
+};
+
+} // namespace func
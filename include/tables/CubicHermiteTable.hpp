@@ -53,7 +53,7 @@ public:
       throw std::invalid_argument("Error in func::CubicHermiteTable: 1st derivative of given function is not provided");
 
     /* Allocate and set table */
-    m_table.reset(new polynomial<TOUT,4>[m_numTableEntries]);
+    allocate_table(m_numTableEntries);
     FUNC_BUILDPAR
     for (unsigned int ii=0; ii<m_numTableEntries-1; ++ii) {
       TIN x;
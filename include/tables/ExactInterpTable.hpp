@@ -57,7 +57,7 @@ public:
       throw std::invalid_argument("Error in func::ExactInterpTable: Given an invalid FunctionContainer");
 
     /* Allocate and set table */
-    m_table.reset(new polynomial<TOUT,N+1>[m_numTableEntries]);
+    allocate_table(m_numTableEntries);
     FUNC_BUILDPAR
     for(unsigned int ii=0; ii<m_numTableEntries-1; ++ii) {
       TIN x = m_minArg + ii*m_stepSize;
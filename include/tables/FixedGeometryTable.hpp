@@ -0,0 +1,107 @@
+/** \file FixedGeometryTable.hpp
+ * \brief A uniform LUT whose geometry is baked into the type.
+ * \ingroup MetaTable
+ *
+ * MetaTable's hash loads m_stepSize_inv and m_minArg from memory on every
+ * call and the interval count is a runtime value. When a table's domain
+ * never changes, FixedGeometryTable moves min/max/numIntervals into
+ * template parameters: the step-size reciprocal constant-folds into the
+ * instruction stream, the compiler can fully unroll Horner (N is already a
+ * template parameter), and power-of-two interval counts let it strength-
+ * reduce the index arithmetic. Changing the geometry means recompiling,
+ * which is the accepted trade for shaving cycles off billions of calls.
+ *
+ * Floating non-type template parameters need C++20, so the bounds are given
+ * as rationals: min = MinNum/Den, max = MaxNum/Den.
+ *
+ * Usage example:
+ * \code{.cpp}
+ *   // a degree 3 table over [0, 10] with 1024 subintervals
+ *   FixedGeometryTable<UniformExactInterpTable<3,double>, 0, 10, 1, 1024> F(fc);
+ *   double val = F(0.87354);
+ * \endcode
+ */
+#pragma once
+#include "MetaTable.hpp"
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+
+namespace func {
+
+template <class LUT_TYPE, std::intmax_t MinNum, std::intmax_t MaxNum, std::intmax_t Den, unsigned int NumIntervals>
+class FixedGeometryTable
+{
+public:
+  using input_type = typename LUT_TYPE::input_type;
+  using output_type = typename LUT_TYPE::output_type;
+
+private:
+  using TIN = input_type;
+  using TOUT = output_type;
+  static constexpr unsigned int N = LUT_TYPE::num_coefs;
+
+  static constexpr TIN s_minArg = static_cast<TIN>(MinNum)/static_cast<TIN>(Den);
+  static constexpr TIN s_maxArg = static_cast<TIN>(MaxNum)/static_cast<TIN>(Den);
+  static constexpr TIN s_stepSize = (s_maxArg - s_minArg)/static_cast<TIN>(NumIntervals);
+  static constexpr TIN s_stepSize_inv = static_cast<TIN>(NumIntervals)/(s_maxArg - s_minArg);
+
+  std::unique_ptr<TOUT[]> m_coefs; //!< flat [interval*N + coef]
+  std::string m_name;
+
+  void adopt(const LUT_TYPE& lut){
+    /* the wrapped table must have been built over exactly our geometry.
+     * MetaTable's ceil can pad one extra subinterval when the step does not
+     * divide the domain exactly in floating point, so allow NumIntervals+1
+     * (the extra entry is copied and only reachable at the padded edge) */
+    if(lut.min_arg() != s_minArg ||
+       (lut.num_subintervals() != NumIntervals && lut.num_subintervals() != NumIntervals+1u))
+      throw std::invalid_argument("Error in func::FixedGeometryTable: table geometry does not match the template parameters");
+    auto tf = lut.transfer_function_coefs();
+    if(tf[0] != TIN(0) || tf[1] != TIN(0) || tf[2] != TIN(0) || tf[3] != TIN(0))
+      throw std::invalid_argument("Error in func::FixedGeometryTable: only uniform tables have compile-time geometry");
+
+    m_name = "FixedGeometry<" + lut.name() + ">";
+    m_coefs.reset(new TOUT[static_cast<std::size_t>(lut.num_table_entries())*N]);
+    for(unsigned int i=0; i<lut.num_table_entries(); i++)
+      for(unsigned int j=0; j<N; j++)
+        m_coefs[static_cast<std::size_t>(i)*N + j] = lut.table_entry(i,j);
+  }
+
+public:
+  static_assert(Den != 0, "FixedGeometryTable: Den must be nonzero");
+  static_assert(NumIntervals > 0, "FixedGeometryTable: need at least one subinterval");
+
+  /** build the wrapped table over the compile-time geometry and adopt its coefficients */
+  FixedGeometryTable(const FunctionContainer<TIN,TOUT>& fc){
+    LUT_TYPE lut(fc, LookupTableParameters<TIN>{s_minArg, s_maxArg, s_stepSize});
+    adopt(lut);
+  }
+
+  /** adopt a prebuilt table (must match the compile-time geometry exactly) */
+  FixedGeometryTable(const LUT_TYPE& lut){ adopt(lut); }
+
+  /** \brief hash with compile-time constants + fully unrolled Horner */
+  inline TOUT operator()(TIN x) const {
+    TIN dx = s_stepSize_inv*(x - s_minArg);
+    unsigned int x0 = static_cast<unsigned int>(dx);
+    dx -= x0;
+
+    const TOUT* c = m_coefs.get() + static_cast<std::size_t>(x0)*N;
+    TOUT sum = c[N-1];
+    for(unsigned int k=N-1; k>0; k--){
+      sum *= dx;
+      sum += c[k-1];
+    }
+    return sum;
+  }
+
+  std::string name() const { return m_name; }
+  static constexpr TIN min_arg(){ return s_minArg; }
+  static constexpr TIN max_arg(){ return s_maxArg; }
+  static constexpr TIN step_size(){ return s_stepSize; }
+  static constexpr unsigned int num_subintervals(){ return NumIntervals; }
+  std::size_t size() const { return static_cast<std::size_t>(NumIntervals+1u)*N*sizeof(TOUT); }
+};
+
+} // namespace func
@@ -0,0 +1,125 @@
+/** \file Flat2DTable.hpp
+ * \brief Flatten a 2D LUT-of-LUTs (see ndimLUT in cxx17utils.hpp) into one
+ * contiguous coefficient block.
+ * \ingroup MetaTable
+ *
+ * A LUT built with ndimLUT stores an inner LUT inside every outer polynomial
+ * coefficient, so each outer coefficient owns its own heap allocated m_table
+ * and evaluating one (x,y) pair chases N1+1 scattered allocations. Flat2DTable
+ * copies the full tensor of coefficients into a single row-major block at
+ * construction: cell (i,jj) holds the N1*N2 coefficients of the bivariate
+ * polynomial for that subrectangle, so evaluation is two uniform hashes plus
+ * one cache-friendly block read.
+ *
+ * Usage example:
+ * \code{.cpp}
+ *   auto LUT  = func::ndimLUT<2,double,double,MyLUT>(f<double>, params);
+ *   func::Flat2DTable<decltype(LUT)> flat(LUT);
+ *   double val = flat(0.87354, -0.2);
+ * \endcode
+ *
+ * Notes:
+ * - Only uniform grids are supported: transfer functions do not work with
+ *   LUTs of LUTs in the first place (see the TODO in MetaTable's operator+=).
+ * - Every inner LUT must share one grid, which ndimLUT guarantees.
+ */
+#pragma once
+#include "MetaTable.hpp"
+#include <memory>
+#include <stdexcept>
+
+namespace func {
+
+template <class OUTER_LUT>
+class Flat2DTable
+{
+public:
+  using outer_type = OUTER_LUT;
+  using inner_type = typename OUTER_LUT::output_type;
+  using input_type = typename OUTER_LUT::input_type;
+  using output_type = typename inner_type::output_type;
+
+private:
+  using TIN  = input_type;
+  using TOUT = output_type;
+  static constexpr unsigned int N1 = OUTER_LUT::num_coefs;  //!< coefs per outer (x) interval
+  static constexpr unsigned int N2 = inner_type::num_coefs; //!< coefs per inner (y) interval
+
+  TIN m_minX, m_stepXinv, m_minY, m_stepYinv;
+  TIN m_maxX, m_maxY;
+  unsigned int m_numXEntries, m_numYEntries;
+  std::unique_ptr<TOUT[]> m_flat; //!< [i][jj][j][k] row-major, so cell (i,jj) is one N1*N2 block
+
+  static bool is_nonuniform(const std::array<TIN,4>& tf_coefs){
+    /* uniform MetaTables never build a transfer function so its coefs stay 0 */
+    return tf_coefs[0] != TIN(0) || tf_coefs[1] != TIN(0) || tf_coefs[2] != TIN(0) || tf_coefs[3] != TIN(0);
+  }
+
+public:
+  Flat2DTable(const OUTER_LUT& outer) :
+    m_minX(outer.min_arg()), m_stepXinv(static_cast<TIN>(1.0)/outer.step_size()), m_maxX(outer.max_arg()),
+    m_numXEntries(outer.num_table_entries())
+  {
+    if(is_nonuniform(outer.transfer_function_coefs()))
+      throw std::invalid_argument("Error in func::Flat2DTable: only uniform LUTs of LUTs can be flattened");
+
+    /* take the inner grid from the first coefficient and insist every other
+     * inner LUT matches it */
+    inner_type inner0 = outer.table_entry(0,0);
+    if(is_nonuniform(inner0.transfer_function_coefs()))
+      throw std::invalid_argument("Error in func::Flat2DTable: only uniform LUTs of LUTs can be flattened");
+    m_minY = inner0.min_arg();
+    m_stepYinv = static_cast<TIN>(1.0)/inner0.step_size();
+    m_maxY = inner0.max_arg();
+    m_numYEntries = inner0.num_table_entries();
+
+    m_flat.reset(new TOUT[static_cast<std::size_t>(m_numXEntries)*m_numYEntries*N1*N2]);
+    for(unsigned int i=0; i<m_numXEntries; i++){
+      for(unsigned int j=0; j<N1; j++){
+        inner_type inner = outer.table_entry(i,j);
+        if(inner.min_arg() != m_minY || inner.step_size() != inner0.step_size() ||
+           inner.num_table_entries() != m_numYEntries)
+          throw std::invalid_argument("Error in func::Flat2DTable: inner LUTs do not share a grid");
+        for(unsigned int jj=0; jj<m_numYEntries; jj++)
+          for(unsigned int k=0; k<N2; k++)
+            m_flat[((static_cast<std::size_t>(i)*m_numYEntries + jj)*N1 + j)*N2 + k] = inner.table_entry(jj,k);
+      }
+    }
+  }
+
+  /** \brief Two uniform hashes, one contiguous block read, nested Horner */
+  TOUT operator()(TIN x, TIN y) const {
+    TIN dx = m_stepXinv*(x-m_minX);
+    unsigned int i = static_cast<unsigned int>(dx);
+    dx -= i;
+    TIN dy = m_stepYinv*(y-m_minY);
+    unsigned int jj = static_cast<unsigned int>(dy);
+    dy -= jj;
+
+    const TOUT* cell = &m_flat[(static_cast<std::size_t>(i)*m_numYEntries + jj)*N1*N2];
+    /* evaluate outer coefficient j at dy with Horner, then Horner those in dx.
+     * (the flat block has no polynomial<> alignment so index it directly) */
+    auto horner_y = [dy](const TOUT* c){
+      TOUT s = c[N2-1];
+      for(unsigned int k=N2-1; k>0; k--){
+        s *= dy;
+        s += c[k-1];
+      }
+      return s;
+    };
+    TOUT sum = horner_y(cell + (N1-1)*N2);
+    for(unsigned int j=N1-1; j>0; j--){
+      sum *= dx;
+      sum += horner_y(cell + (j-1)*N2);
+    }
+    return sum;
+  }
+
+  TIN min_arg1() const { return m_minX; }
+  TIN max_arg1() const { return m_maxX; }
+  TIN min_arg2() const { return m_minY; }
+  TIN max_arg2() const { return m_maxY; }
+  std::size_t size() const { return static_cast<std::size_t>(m_numXEntries)*m_numYEntries*N1*N2*sizeof(TOUT); }
+};
+
+} // namespace func
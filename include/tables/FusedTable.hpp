@@ -0,0 +1,101 @@
+/** \file FusedTable.hpp
+ * \brief One hash, K interleaved outputs.
+ * \ingroup MetaTable
+ *
+ * Callers that always evaluate several functions at the same argument (eg.
+ * thermodynamic triples mu(T), cp(T), k(T)) pay K hashes and K scattered
+ * memory streams when using K independent LUTs. FusedTable builds K tables
+ * of the same type over one shared uniform grid and interleaves their
+ * polynomials per interval in one contiguous block, so an evaluation is a
+ * single hash followed by K Horner loops over one cache-friendly cell.
+ *
+ * Usage example:
+ * \code{.cpp}
+ *   std::array<func::FunctionContainer<double>,3> fcs = {mu_fc, cp_fc, k_fc};
+ *   func::FusedTable<func::UniformExactInterpTable<3,double>,3> F(fcs, {0,10,0.001});
+ *   std::array<double,3> vals = F(0.87354); // {mu, cp, k}
+ * \endcode
+ *
+ * Notes:
+ * - Uniform grids only: a nonuniform partition is tuned to one function's
+ *   derivative so the K tables could not share a hash.
+ * - The K throwaway source tables only live during construction.
+ */
+#pragma once
+#include "MetaTable.hpp"
+#include <array>
+#include <memory>
+#include <stdexcept>
+
+namespace func {
+
+template <class LUT_TYPE, unsigned int K>
+class FusedTable
+{
+public:
+  using input_type = typename LUT_TYPE::input_type;
+  using output_type = std::array<typename LUT_TYPE::output_type,K>;
+
+private:
+  using TIN = input_type;
+  using TOUT = typename LUT_TYPE::output_type;
+  static constexpr unsigned int N = LUT_TYPE::num_coefs;
+
+  std::string m_name;
+  TIN m_minArg, m_maxArg, m_stepSize_inv;
+  unsigned int m_numTableEntries;
+  std::unique_ptr<TOUT[]> m_fused; //!< [i][k][j]: interval i holds the K polynomials back to back
+
+public:
+  FusedTable(const std::array<FunctionContainer<TIN,TOUT>,K>& fcs, const LookupTableParameters<TIN>& par){
+    static_assert(K > 0u, "FusedTable needs at least one function");
+    for(unsigned int k=0; k<K; k++){
+      LUT_TYPE lut(fcs[k], par);
+      auto tf_coefs = lut.transfer_function_coefs();
+      if(tf_coefs[0] != TIN(0) || tf_coefs[1] != TIN(0) || tf_coefs[2] != TIN(0) || tf_coefs[3] != TIN(0))
+        throw std::invalid_argument("Error in func::FusedTable: only uniform LUTs can share a hash");
+
+      if(k == 0){
+        m_name = "Fused<" + lut.name() + "," + std::to_string(K) + ">";
+        m_minArg = lut.min_arg();
+        m_maxArg = lut.max_arg();
+        m_stepSize_inv = static_cast<TIN>(1.0)/lut.step_size();
+        m_numTableEntries = lut.num_table_entries();
+        m_fused.reset(new TOUT[static_cast<std::size_t>(m_numTableEntries)*K*N]);
+      }
+      /* all K tables are built from the same parameters so their geometry
+       * cannot differ; interleave this table's coefficients */
+      for(unsigned int i=0; i<m_numTableEntries; i++)
+        for(unsigned int j=0; j<N; j++)
+          m_fused[(static_cast<std::size_t>(i)*K + k)*N + j] = lut.table_entry(i,j);
+    }
+  }
+
+  /** \brief One uniform hash, then K Horner evaluations from one contiguous cell */
+  output_type operator()(TIN x) const {
+    TIN dx = m_stepSize_inv*(x-m_minArg);
+    unsigned int x0 = static_cast<unsigned int>(dx);
+    dx -= x0;
+
+    const TOUT* cell = &m_fused[static_cast<std::size_t>(x0)*K*N];
+    output_type out;
+    for(unsigned int k=0; k<K; k++){
+      const TOUT* c = cell + k*N;
+      TOUT sum = c[N-1];
+      for(unsigned int j=N-1; j>0; j--){
+        sum *= dx;
+        sum += c[j-1];
+      }
+      out[k] = sum;
+    }
+    return out;
+  }
+
+  std::string name() const { return m_name; }
+  TIN min_arg() const { return m_minArg; }
+  TIN max_arg() const { return m_maxArg; }
+  std::size_t size() const { return static_cast<std::size_t>(m_numTableEntries)*K*N*sizeof(TOUT); }
+  unsigned int num_table_entries() const { return m_numTableEntries; }
+};
+
+} // namespace func
@@ -49,7 +49,7 @@ public:
       throw std::invalid_argument("Error in func::LinearRawInterpTable: Given an invalid FunctionContainer");
 
     /* Allocate and set table */
-    m_table.reset(new polynomial<TOUT,1>[m_numTableEntries]);
+    allocate_table(m_numTableEntries);
 
     FUNC_BUILDPAR
     for (unsigned int ii=0; ii<m_numTableEntries-1; ++ii) {
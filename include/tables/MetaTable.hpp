@@ -5,8 +5,22 @@
 
 #include <array>
 #include <stdexcept>
+#include <fstream> // write_binary/read_binary
+#include <cstring> // memcpy magic bytes
+#include <cstdint> // uint64_t offsets
+#include <cstdlib> // posix_memalign, free
+#include <new>     // placement new into aligned allocations
 #include "json.hpp"
 
+/* read_binary memory-maps LUT files on POSIX systems */
+#if defined(__unix__) || (defined(__APPLE__) && defined(__MACH__))
+#define FUNC_USE_MMAP
+#include <sys/mman.h> // mmap, munmap
+#include <sys/stat.h> // fstat
+#include <fcntl.h>    // open
+#include <unistd.h>   // close
+#endif
+
 /* Classes inheriting MetaTable need this macro to access member variables without
    writing "this->" excessively. These "using" statements must have protected access */
 #define INHERIT_META(N,TIN,TOUT,GT) \
@@ -21,16 +35,87 @@
   using MetaTable<N,TIN,TOUT,GT>::m_stepSize_inv; \
   using MetaTable<N,TIN,TOUT,GT>::m_tableMaxArg; \
   using MetaTable<N,TIN,TOUT,GT>::m_table; \
-  using MetaTable<N,TIN,TOUT,GT>::m_transferFunction
+  using MetaTable<N,TIN,TOUT,GT>::m_transferFunction; \
+  using MetaTable<N,TIN,TOUT,GT>::allocate_table
 
-/* Parallelization macro. Notes:
- * - we could align m_table to sizeof(TOUT) to get some more speedup? */
+/* Parallelization macro. Note: m_table allocations are cache-line aligned
+ * (see MetaTable::allocate_table) */
 #define FUNC_BUILDPAR _Pragma("omp parallel for schedule(dynamic)")
 
 namespace func {
 
 enum class GridTypes {UNIFORM, NONUNIFORM};
 
+/** Coefficient layouts for batch evaluation:
+ * - AOS: all N coefficients of one subinterval are contiguous (m_table's
+ *   native layout). Best for scalar-heavy callers.
+ * - SOA: coefficient k of every subinterval is contiguous, so lanes of a
+ *   vectorized batch eval load coefficients with unit stride instead of
+ *   strided gathers. Best for wide-SIMD machines. */
+enum class StorageLayout {AOS, SOA};
+
+/** Out-of-domain policies for MetaTable::eval_at (compile-time selected):
+ * - CLAMP: branchless clamp of x to [minArg,maxArg] before the usual hash.
+ *   Correct whenever saturating at the domain edge is physically sensible,
+ *   and much cheaper than FailureProofTable's compare-and-fallback.
+ * - EXTRAPOLATE: evaluate the edge subinterval's polynomial outside its
+ *   interval. Only the table index is clamped, so x below (above) the domain
+ *   extrapolates the first (last) polynomial. */
+enum class OutOfDomainPolicy {CLAMP, EXTRAPOLATE};
+
+/** \brief Minimal interface for arena-backed table allocation.
+ *
+ * When an arena is active (see utils/TableArena.hpp and its RAII Scope),
+ * MetaTable::allocate_table draws coefficient storage from it instead of the
+ * heap, so tables built together (factory batches, CompositeLookupTable) are
+ * packed contiguously. Arena-backed tables run their element destructors but
+ * never free: the arena releases its blocks wholesale. */
+class TableArenaBase {
+public:
+  virtual void* allocate(std::size_t bytes, std::size_t alignment) = 0;
+  virtual ~TableArenaBase(){}
+  /** the arena new tables currently allocate from (null = normal heap) */
+  static TableArenaBase*& active(){
+    static TableArenaBase* arena = nullptr;
+    return arena;
+  }
+};
+
+/** \brief Deleter for MetaTable::m_table.
+ *
+ * m_table usually owns heap memory from new[], but read_binary can point it
+ * into a read-only shared mmap of a LUT file, in which case the whole mapping
+ * must be munmap'ed instead. A freshly built table always carries a
+ * default-constructed (heap) deleter; the mmap state only enters through
+ * unique_ptr assignment so it can never dangle across a reset(new ...). */
+template <typename TOUT, unsigned int N>
+struct TableDeleter {
+  void* map_base = nullptr;     //!< non-null iff the table lives in an mmap'ed file
+  std::size_t map_length = 0;
+  bool is_static = false;       //!< true iff the table points at static (eg. constexpr) data we do not own
+  bool arena_backed = false;    //!< true iff the memory belongs to a TableArena (destroy elements, never free)
+  std::size_t aligned_count = 0; //!< non-zero iff elements were placement-new'd (count of entries to destroy)
+  void operator()(polynomial<TOUT,N>* p) const {
+    if(is_static)
+      return;
+#ifdef FUNC_USE_MMAP
+    if(map_base != nullptr){
+      munmap(map_base, map_length);
+      return;
+    }
+    if(aligned_count != 0){
+      using P = polynomial<TOUT,N>;
+      for(std::size_t i=0; i<aligned_count; i++)
+        p[i].~P();
+      if(!arena_backed)
+        free(p); // arena memory is released wholesale by the arena itself
+      return;
+    }
+#endif
+    delete[] p;
+  }
+};
+
 template <GridTypes GT>
 inline std::string grid_type_to_string() {
   FUNC_IF_CONSTEXPR(GT == GridTypes::UNIFORM){
@@ -78,9 +163,61 @@ protected:
   std::size_t  m_dataSize;        //!< size of relevant data for impl evaluation
   unsigned int m_numIntervals;    //!< = (m_tableMaxArg - m_minArg)/m_stepSize;
   unsigned int m_numTableEntries; //!< length of m_table (usually = m_numIntervals + 1)
-  __attribute__((aligned)) std::unique_ptr<polynomial<TOUT,N>[]> m_table; //!< holds polynomials coefficients
+  __attribute__((aligned)) std::unique_ptr<polynomial<TOUT,N>[],TableDeleter<TOUT,N>> m_table; //!< holds polynomials coefficients
   TransferFunction<TIN> m_transferFunction; //!< used to make nonuniform grids (default constructable)
 
+  /* coefficient-major mirror of m_table used by eval<StorageLayout::SOA>.
+   * Built lazily on first use and invalidated whenever coefficients change.
+   * m_table stays the canonical copy (construction & JSON are unaffected). */
+  mutable std::unique_ptr<TOUT[]> m_soaTable;
+
+  /* m_diffTables[s-1] holds the coefficients of p_k^(s) with the
+   * permutation and stepsize factors already folded in, so diff(s,x) can be
+   * the same hash + Horner as operator() (see precompute_derivative_tables).
+   * Invalidated whenever coefficients change. */
+  std::vector<std::unique_ptr<polynomial<TOUT,N>[]>> m_diffTables;
+
+  /** \brief Allocate m_table with space for n entries, 64-byte aligned.
+   *
+   * Every implementation allocates through this (rather than reset(new ...))
+   * so the coefficient array starts on a cache line boundary; combined with
+   * polynomial's own alignment an interval then straddles as few lines as
+   * possible. Falls back to plain new[] off POSIX. The assignment also
+   * guarantees a fresh (heap/aligned) deleter regardless of what backed the
+   * table before. */
+  void allocate_table(unsigned int n){
+#ifdef FUNC_USE_MMAP
+    /* high-degree polynomials can be over-aligned past a cache line
+     * (alignments[] reaches 16*sizeof(TOUT)) so never request less than
+     * the type's own alignment */
+    constexpr std::size_t table_alignment = alignof(polynomial<TOUT,N>) > 64u ? alignof(polynomial<TOUT,N>) : 64u;
+    void* mem = nullptr;
+    bool from_arena = TableArenaBase::active() != nullptr;
+    if(from_arena)
+      mem = TableArenaBase::active()->allocate(n*sizeof(polynomial<TOUT,N>), table_alignment);
+    else if(posix_memalign(&mem, table_alignment, n*sizeof(polynomial<TOUT,N>)) != 0)
+      throw std::bad_alloc();
+    auto* p = static_cast<polynomial<TOUT,N>*>(mem);
+    for(unsigned int i=0; i<n; i++)
+      new(p+i) polynomial<TOUT,N>;
+    TableDeleter<TOUT,N> aligned_deleter;
+    aligned_deleter.aligned_count = n;
+    aligned_deleter.arena_backed = from_arena;
+    m_table = std::unique_ptr<polynomial<TOUT,N>[],TableDeleter<TOUT,N>>(p, aligned_deleter);
+#else
+    m_table = std::unique_ptr<polynomial<TOUT,N>[],TableDeleter<TOUT,N>>(new polynomial<TOUT,N>[n]);
+#endif
+  }
+
+  /** \brief Pack m_table into m_soaTable so coefficient k of every subinterval is contiguous */
+  void pack_soa() const {
+    TOUT* soa = new TOUT[static_cast<std::size_t>(m_numTableEntries)*N];
+    for(unsigned int ii=0; ii<m_numTableEntries; ++ii)
+      for(unsigned int jj=0; jj<N; ++jj)
+        soa[jj*m_numTableEntries + ii] = m_table[ii].coefs[jj];
+    m_soaTable.reset(soa);
+  }
+
   /** \brief Copy-swap pattern, necessary for `operator=`
    *  \post L is overwritten by the data in `this*` and `this*` loses access to its data. */
   void swap(MetaTable<N,TIN,TOUT,GT>& L) noexcept {
@@ -96,10 +233,15 @@ protected:
     L.m_tableMaxArg = m_tableMaxArg;
     L.m_transferFunction = m_transferFunction;
     L.m_table = std::move(m_table);
+    L.m_soaTable = std::move(m_soaTable);
+    L.m_diffTables = std::move(m_diffTables);
     return;
   }
 
 public:
+  /* compile-time mirror of ncoefs_per_entry() for code templated on a LUT type */
+  static constexpr unsigned int num_coefs = N;
+
   /* using a std::unique_ptr member variables implicitly deletes the default
    * move ctor so we must explicitly ask for the default move ctor */
   MetaTable() = default;
@@ -109,7 +251,7 @@ public:
     m_stepSize(L.m_stepSize), m_stepSize_inv(L.m_stepSize_inv), m_tableMaxArg(L.m_tableMaxArg),
     m_order(L.m_order), m_dataSize(L.m_dataSize), m_numIntervals(L.m_numIntervals), m_numTableEntries(L.m_numTableEntries)
   {
-    m_table.reset(new polynomial<TOUT,N>[m_numTableEntries]);
+    allocate_table(m_numTableEntries);
     #pragma omp simd collapse(2)
     for(unsigned int ii=0; ii<m_numTableEntries; ++ii)
       for(unsigned int jj=0; jj<N; ++jj)
@@ -148,8 +290,13 @@ public:
 
     /* build the transfer function for nonuniform grids
      * TODO could make transfer function coefficients a field in LookupTableParameters */
-    FUNC_IF_CONSTEXPR(GT != GridTypes::UNIFORM)
-      m_transferFunction = TransferFunction<TIN>(func_container,m_minArg,m_tableMaxArg,m_stepSize);
+    FUNC_IF_CONSTEXPR(GT != GridTypes::UNIFORM){
+      if(!par.usage_histogram.empty())
+        m_transferFunction = TransferFunction<TIN>(par.usage_histogram, par.usage_min, par.usage_max,
+            m_minArg, m_tableMaxArg, m_stepSize);
+      else
+        m_transferFunction = TransferFunction<TIN>(func_container,m_minArg,m_tableMaxArg,m_stepSize);
+    }
   }
 
   /* public access to protected member vars */
@@ -178,6 +325,204 @@ public:
     out << jsonStats.dump(2) << std::endl;
   }
 
+  /** \brief Write this LUT to filename so the coefficient array's on-disk
+   * bytes are exactly the in-memory polynomial<TOUT,N>[] layout.
+   *
+   * The file is a small json metadata header (padded to a page boundary so
+   * the data keeps its alignment) followed by the raw m_table bytes, so
+   * read_binary can point m_table straight into a shared mapping with no
+   * parse step. Unlike to_json this is not portable across machines with
+   * different endianness or type sizes (sizeof(polynomial) is checked on
+   * load). Only usable when TOUT is trivially copyable. */
+  void write_binary(const std::string& filename) const {
+    static_assert(std::is_trivially_copyable<TOUT>::value,
+        "write_binary stores raw coefficient bytes so TOUT must be trivially copyable");
+    nlohmann::json meta;
+    meta["name"] = m_name;
+    meta["minArg"] = m_minArg;
+    meta["maxArg"] = m_maxArg;
+    meta["order"] = m_order;
+    meta["dataSize"] = m_dataSize;
+    meta["stepSize"] = m_stepSize;
+    meta["numTableEntries"] = m_numTableEntries;
+    meta["numIntervals"] = m_numIntervals;
+    meta["tableMaxArg"] = m_tableMaxArg;
+    meta["transfer_function_coefs"] = m_transferFunction.get_coefs();
+    meta["sizeofEntry"] = sizeof(polynomial<TOUT,N>);
+    meta["ncoefsPerEntry"] = N;
+    std::string header = meta.dump();
+
+    /* keep the coefficient array page aligned so its alignment in the mapping
+     * is at least as strict as alignof(polynomial<TOUT,N>) */
+    const std::uint64_t header_len = header.size();
+    std::uint64_t data_offset = 4096u*((8u + 2u*sizeof(std::uint64_t) + header_len + 4095u)/4096u);
+
+    std::ofstream out(filename, std::ios::binary);
+    out.write("FunCLUT1", 8);
+    out.write(reinterpret_cast<const char*>(&header_len), sizeof(header_len));
+    out.write(reinterpret_cast<const char*>(&data_offset), sizeof(data_offset));
+    out.write(header.data(), header.size());
+    std::string padding(data_offset - 8u - 2u*sizeof(std::uint64_t) - header_len, '\0');
+    out.write(padding.data(), padding.size());
+    out.write(reinterpret_cast<const char*>(m_table.get()), m_numTableEntries*sizeof(polynomial<TOUT,N>));
+    if(!out)
+      throw std::invalid_argument("Error in func::MetaTable.write_binary: could not write to " + filename);
+  }
+
+  /** \brief Point m_table into a read-only shared memory mapping of a file
+   * written by write_binary.
+   *
+   * There is no parse step and, because the mapping is backed by the page
+   * cache, concurrent processes (eg. MPI ranks on one node) share a single
+   * physical copy of the coefficients. Overwrites every member of *this; the
+   * caller is responsible for using the same table type that wrote the file
+   * (the stored name is restored but not enforced). POSIX only. */
+  void read_binary(const std::string& filename) {
+#ifndef FUNC_USE_MMAP
+    (void) filename;
+    throw std::invalid_argument("Error in func::MetaTable.read_binary: memory mapped LUTs require a POSIX system");
+#else
+    static_assert(std::is_trivially_copyable<TOUT>::value,
+        "read_binary reads raw coefficient bytes so TOUT must be trivially copyable");
+    int fd = open(filename.c_str(), O_RDONLY);
+    if(fd < 0)
+      throw std::invalid_argument("Error in func::MetaTable.read_binary: cannot open " + filename);
+    struct stat st;
+    fstat(fd, &st);
+    std::size_t length = static_cast<std::size_t>(st.st_size);
+    void* base = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd); // the mapping keeps the file alive
+    if(base == MAP_FAILED)
+      throw std::invalid_argument("Error in func::MetaTable.read_binary: mmap failed on " + filename);
+
+    const char* bytes = static_cast<const char*>(base);
+    std::uint64_t header_len, data_offset;
+    if(length < 8u + 2u*sizeof(std::uint64_t) || std::memcmp(bytes, "FunCLUT1", 8) != 0){
+      munmap(base, length);
+      throw std::invalid_argument("Error in func::MetaTable.read_binary: " + filename + " is not a FunC binary LUT file");
+    }
+    std::memcpy(&header_len, bytes+8, sizeof(header_len));
+    std::memcpy(&data_offset, bytes+8+sizeof(header_len), sizeof(data_offset));
+    /* never trust offsets read from a file: a truncated/corrupt header must
+     * throw instead of reading past the end of the mapping */
+    if(8u + 2u*sizeof(std::uint64_t) + header_len > length || data_offset > length){
+      munmap(base, length);
+      throw std::invalid_argument("Error in func::MetaTable.read_binary: " + filename + " is truncated or corrupt");
+    }
+
+    nlohmann::json meta = nlohmann::json::parse(bytes + 8 + 2*sizeof(std::uint64_t),
+                                                bytes + 8 + 2*sizeof(std::uint64_t) + header_len);
+    if(meta.at("sizeofEntry").get<std::size_t>() != sizeof(polynomial<TOUT,N>) ||
+       meta.at("ncoefsPerEntry").get<unsigned int>() != N){
+      munmap(base, length);
+      throw std::invalid_argument("Error in func::MetaTable.read_binary: " + filename +
+          " was written with an incompatible polynomial layout");
+    }
+
+    meta.at("name").get_to(m_name);
+    meta.at("minArg").get_to(m_minArg);
+    meta.at("maxArg").get_to(m_maxArg);
+    meta.at("order").get_to(m_order);
+    meta.at("dataSize").get_to(m_dataSize);
+    meta.at("stepSize").get_to(m_stepSize);
+    m_stepSize_inv = static_cast<TIN>(1.0)/m_stepSize;
+    meta.at("numTableEntries").get_to(m_numTableEntries);
+    meta.at("numIntervals").get_to(m_numIntervals);
+    meta.at("tableMaxArg").get_to(m_tableMaxArg);
+    if(data_offset + m_numTableEntries*sizeof(polynomial<TOUT,N>) > length){
+      munmap(base, length);
+      throw std::invalid_argument("Error in func::MetaTable.read_binary: " + filename + " is truncated or corrupt");
+    }
+    m_transferFunction = TransferFunction<TIN>(meta.at("transfer_function_coefs").get<std::array<TIN,4>>());
+
+    /* the coefficients are never copied: m_table points into the mapping and
+     * the deleter munmaps it. const_cast is sound because every evaluation
+     * path only reads through m_table (mutating a mapped LUT is caller error,
+     * just like writing through PROT_READ memory anywhere else). */
+    auto* table = reinterpret_cast<polynomial<TOUT,N>*>(const_cast<char*>(bytes) + data_offset);
+    m_table = std::unique_ptr<polynomial<TOUT,N>[],TableDeleter<TOUT,N>>(table, TableDeleter<TOUT,N>{base, length});
+    m_soaTable.reset();
+    m_diffTables.clear();
+#endif
+  }
+
+  /** \brief Adopt a static coefficient array (eg. a constexpr std::array in
+   * .rodata emitted by print_hpp) without copying.
+   *
+   * Overwrites every member of *this. The table never owns `data`: the
+   * deleter is a no-op, so tables over compile-time-embedded coefficients
+   * start in zero time and the OS shares their pages across processes.
+   * const_cast is sound for the same reason as in read_binary: every
+   * evaluation path only reads through m_table. */
+  void adopt_static_table(const polynomial<TOUT,N>* data, std::string name,
+      TIN minArg, TIN maxArg, TIN stepSize, unsigned int order,
+      unsigned int numIntervals, unsigned int numTableEntries, TIN tableMaxArg,
+      std::array<TIN,4> transfer_coefs = {{0,0,0,0}}) {
+    m_name = name;
+    m_minArg = minArg;
+    m_maxArg = maxArg;
+    m_stepSize = stepSize;
+    m_stepSize_inv = static_cast<TIN>(1.0)/m_stepSize;
+    m_order = order;
+    m_numIntervals = numIntervals;
+    m_numTableEntries = numTableEntries;
+    m_tableMaxArg = tableMaxArg;
+    m_dataSize = m_numTableEntries*sizeof(polynomial<TOUT,N>);
+    m_transferFunction = TransferFunction<TIN>(transfer_coefs);
+    TableDeleter<TOUT,N> noop_deleter; noop_deleter.is_static = true;
+    m_table = std::unique_ptr<polynomial<TOUT,N>[],TableDeleter<TOUT,N>>(
+        const_cast<polynomial<TOUT,N>*>(data), noop_deleter);
+    m_soaTable.reset();
+    m_diffTables.clear();
+  }
+
+  /** \brief Emit a generated C++ header embedding this LUT's coefficients as
+   * a constexpr std::array, plus a maker function that adopts the data with
+   * adopt_static_table (no parse, no allocation, shared .rodata pages).
+   *
+   * identifier names the generated symbols, and tout_name must spell the
+   * TOUT type as C++ source (we cannot portably stringify a type).
+   * Only sensible when TIN/TOUT print losslessly with max_digits10 (eg.
+   * float/double). Usage of the generated header:
+   * \code{.cpp}
+   *   #include "mytable_lut.hpp"
+   *   auto lut = func_generated::make_mytable<func::UniformExactInterpTable<3,double>>();
+   * \endcode */
+  void print_hpp(std::ostream& out, const std::string& identifier,
+      const std::string& tout_name = "double") const {
+    auto prec = out.precision(std::numeric_limits<TOUT>::max_digits10);
+    out << "/* " << identifier << ": coefficients of " << m_name << " over ["
+        << m_minArg << "," << m_maxArg << "].\n"
+        << " * Generated by func::MetaTable::print_hpp. Do not edit. */\n"
+        << "#pragma once\n"
+        << "#include \"func.hpp\"\n"
+        << "#include <array>\n\n"
+        << "namespace func_generated {\n\n"
+        << "static constexpr std::array<func::polynomial<" << tout_name << "," << N << ">,"
+        << m_numTableEntries << "> " << identifier << "_table = {{\n";
+    for(unsigned int ii=0; ii<m_numTableEntries; ++ii){
+      out << "  {{";
+      for(unsigned int jj=0; jj<N; ++jj)
+        out << m_table[ii].coefs[jj] << (jj+1<N ? "," : "");
+      out << "}}" << (ii+1<m_numTableEntries ? ",\n" : "\n");
+    }
+    out << "}};\n\n";
+
+    out.precision(std::numeric_limits<TIN>::max_digits10);
+    auto tf_coefs = m_transferFunction.get_coefs();
+    out << "template <typename LUT_TYPE>\n"
+        << "LUT_TYPE make_" << identifier << "(){\n"
+        << "  LUT_TYPE lut;\n"
+        << "  lut.adopt_static_table(" << identifier << "_table.data(), \"" << m_name << "\",\n"
+        << "      " << m_minArg << ", " << m_maxArg << ", " << m_stepSize << ", " << m_order << "u,\n"
+        << "      " << m_numIntervals << "u, " << m_numTableEntries << "u, " << m_tableMaxArg << ",\n"
+        << "      {{" << tf_coefs[0] << "," << tf_coefs[1] << "," << tf_coefs[2] << "," << tf_coefs[3] << "}});\n"
+        << "  return lut;\n"
+        << "}\n\n"
+        << "} // namespace func_generated\n";
+    out.precision(prec);
+  }
+
   unsigned int num_table_entries() const { return m_numTableEntries; }
   unsigned int ncoefs_per_entry() const { return N; }
   TOUT table_entry(unsigned int i, unsigned int j) const { return m_table[i].coefs[j]; }
@@ -198,6 +543,8 @@ public:
    * Maybe we could implement polynomial using an existing linear algebra library with fast
    * (possibly template expression based) operator+ and operator*? */
   MetaTable<N,TIN,TOUT,GT>& operator+=(const MetaTable<N,TIN,TOUT,GT>& other) {
+    m_soaTable.reset(); // coefficients change so the SoA mirror is stale
+    m_diffTables.clear(); // ...and so are any derivative tables
     if((m_numTableEntries != other.m_numTableEntries) || (m_minArg != other.m_minArg) || (m_maxArg != other.m_maxArg))
       throw std::invalid_argument("Error in func::MetaTable: cannot add two LUTs with different subintervals");
 
@@ -211,6 +558,8 @@ public:
     return *this;
   }
   MetaTable<N,TIN,TOUT,GT>& operator-=(const MetaTable<N,TIN,TOUT,GT>& other) {
+    m_soaTable.reset(); // coefficients change so the SoA mirror is stale
+    m_diffTables.clear(); // ...and so are any derivative tables
     if((m_numTableEntries != other.m_numTableEntries) || (m_minArg != other.m_minArg) || (m_maxArg != other.m_maxArg))
       throw std::invalid_argument("Error in func::MetaTable: cannot subtract two LUTs with different subintervals");
 
@@ -221,6 +570,8 @@ public:
     return *this;
   }
   MetaTable<N,TIN,TOUT,GT>& operator*=(const TIN& a) {
+    m_soaTable.reset(); // coefficients change so the SoA mirror is stale
+    m_diffTables.clear(); // ...and so are any derivative tables
     #pragma omp simd collapse(2)
     for(unsigned int ii=0; ii<m_numTableEntries; ++ii)
       for(unsigned int jj=0; jj<N; ++jj)
@@ -228,6 +579,8 @@ public:
     return *this;
   }
   MetaTable<N,TIN,TOUT,GT>& operator/=(const TIN& a) {
+    m_soaTable.reset(); // coefficients change so the SoA mirror is stale
+    m_diffTables.clear(); // ...and so are any derivative tables
     #pragma omp simd collapse(2)
     for(unsigned int ii=0; ii<m_numTableEntries; ++ii)
       for(unsigned int jj=0; jj<N; ++jj)
@@ -255,6 +608,95 @@ public:
     return std::make_pair(x0, x); // we don't subtract dx by x0 because every polynomial was rescaled during construction
   }
 
+  /** \brief operator() with a compile-time out-of-domain policy.
+   *
+   * FailureProofTable bounds-checks every argument and falls back to a
+   * type-erased std::function call, which costs ~2x even when nearly all
+   * arguments are in range. When clamping or extrapolating at the domain
+   * edge is acceptable, eval_at keeps everything in the table: CLAMP turns
+   * into min/max instructions on the argument and EXTRAPOLATE only clamps
+   * the table index, so neither adds a data-dependent branch. The policy is
+   * a template parameter of the call rather than of the table class because
+   * every implementation is final and the policy is a property of the call
+   * site, not of the stored coefficients. */
+  template <OutOfDomainPolicy ODP>
+  inline TOUT eval_at(TIN x) const {
+    FUNC_IF_CONSTEXPR(ODP == OutOfDomainPolicy::CLAMP){
+      /* ternaries on floating point compile to min/max instructions.
+       * hash(m_maxArg) is in range by construction (the extra table entry) */
+      x = x < m_minArg ? m_minArg : (x > m_maxArg ? m_maxArg : x);
+      return operator()(x);
+    }
+
+    /* EXTRAPOLATE: clamp only the index. dx is left relative to the edge
+     * subinterval so it falls outside [0,1) and Horner extrapolates */
+    /* clamp before the int cast: casting a TIN beyond int's range is UB so
+     * the comparison must pick the edge index without evaluating the cast */
+    const TIN last = static_cast<TIN>(m_numIntervals-1u);
+    int x0; TIN dx;
+    FUNC_IF_CONSTEXPR(GT == GridTypes::UNIFORM){
+      dx = m_stepSize_inv*(x-m_minArg);
+      x0 = dx <= static_cast<TIN>(0) ? 0 : (dx >= last ? static_cast<int>(m_numIntervals-1u) : static_cast<int>(dx));
+      dx -= x0;
+    }else{
+      /* nonuniform polynomials map [x_k,x_{k+1}] directly so dx is x itself */
+      TIN inv = m_transferFunction.inverse(x);
+      x0 = inv <= static_cast<TIN>(0) ? 0 : (inv >= last ? static_cast<int>(m_numIntervals-1u) : static_cast<int>(inv));
+      dx = x;
+    }
+
+    TOUT sum = m_table[x0].coefs[N-1];
+    for(unsigned int k=N-1; k>0; k--){
+      sum *= dx;
+      sum += m_table[x0].coefs[k-1];
+    }
+    return sum;
+  }
+
+  /** \brief Precompute differentiated coefficient tables for derivative
+   * orders 1..max_s so diff(s,x) costs the same hash + Horner as operator().
+   *
+   * diff() otherwise recomputes permutation scaling factors and
+   * pow(m_stepSize_inv,s) on every call, which makes Jacobian assembly with
+   * s=1 several times slower than plain lookups. Each requested order costs
+   * one extra coefficient array of the same size as m_table. The companion
+   * tables reproduce diff()'s results exactly (including its stepsize
+   * scaling) and are dropped whenever the coefficients change. */
+  void precompute_derivative_tables(unsigned int max_s){
+    m_diffTables.clear();
+    if(!m_table)
+      return; // nothing to differentiate on an empty table
+    for(unsigned int ss=1; ss<=max_s; ss++){
+      std::unique_ptr<polynomial<TOUT,N>[]> dtable(new polynomial<TOUT,N>[m_numTableEntries]);
+      TIN scale = static_cast<TIN>(pow(m_stepSize_inv,ss));
+      for(unsigned int ii=0; ii<m_numTableEntries; ++ii){
+        for(unsigned int k=0; k<N; ++k){
+          if(k+ss <= N-1)
+            dtable[ii].coefs[k] = scale*static_cast<TIN>(permutation(k+ss,ss))*m_table[ii].coefs[k+ss];
+          else
+            dtable[ii].coefs[k] = static_cast<TIN>(0)*m_table[ii].coefs[0]; // a zero of TOUT's shape
+        }
+      }
+      m_diffTables.push_back(std::move(dtable));
+    }
+  }
+
+  /** \brief Issue a software prefetch for the coefficients that a future
+   * evaluation at x will need.
+   *
+   * Callers that know their next arguments several iterations ahead (eg.
+   * particle codes) can hide the DRAM latency of a table miss by calling
+   * prefetch(x_next) before doing other work. Costs one hash; a no-op on
+   * compilers without __builtin_prefetch. */
+  inline void prefetch(TIN x) const {
+#if defined(__GNUC__) || defined(__clang__)
+    unsigned int x0 = hash<GT>(x).first;
+    __builtin_prefetch(&m_table[x0]);
+#else
+    (void) x;
+#endif
+  }
+
   /** Find the subinterval [x_k,x_{k+1}) that x belongs to, fetch polynomial
    * coefficients from m_table[k], and use Horner's method to compute p_k(x).
    *
@@ -266,7 +708,16 @@ public:
   TOUT operator()(TIN x) const override {
     unsigned int x0; TIN dx;
     std::tie(x0,dx) = hash<GT>(x);
-    
+
+#ifndef FUNC_NO_ESTRIN
+    /* high-degree polynomials switch to Estrin's scheme: Horner is a serial
+     * chain of N-1 dependent FMAs while Estrin's tree has depth ~log2(N).
+     * Only the rounding association differs. -DFUNC_NO_ESTRIN restores
+     * Horner everywhere */
+    FUNC_IF_CONSTEXPR(N >= 5)
+      return eval_estrin<N>(m_table[x0], dx);
+#endif
+
     // general degree horners method, evaluated from the inside out.
     TOUT sum = m_table[x0].coefs[N-1];
     for(unsigned int k=N-1; k>0; k--){
@@ -276,6 +727,79 @@ public:
     return sum;
   }
 
+  /** \brief Evaluate the LUT at each of the n points in xs, writing results to out.
+   *
+   * Unlike looping over operator(), the hash is written out inline (no
+   * std::pair return) so the compiler can vectorize the index computation and
+   * use FMA across lanes of the Horner loop. Overrides the scalar fallback
+   * loop in the LookupTable interface. */
+  void eval(const TIN* xs, TOUT* out, std::size_t n) const override {
+    #pragma omp simd
+    for(std::size_t i=0; i<n; i++){
+      unsigned int x0; TIN dx;
+      FUNC_IF_CONSTEXPR(GT == GridTypes::UNIFORM){
+        dx = m_stepSize_inv*(xs[i]-m_minArg);
+        x0 = static_cast<unsigned int>(dx);
+        dx -= x0;
+      }else{
+        x0 = static_cast<unsigned int>(m_transferFunction.inverse(xs[i]));
+        dx = xs[i]; // nonuniform polynomials were rescaled during construction
+      }
+
+      TOUT sum = m_table[x0].coefs[N-1];
+      for(unsigned int k=N-1; k>0; k--){
+        sum *= dx;
+        sum += m_table[x0].coefs[k-1];
+      }
+      out[i] = sum;
+    }
+  }
+
+  /** \brief Batch evaluation with a compile-time choice of coefficient layout.
+   *
+   * eval<StorageLayout::AOS> is exactly eval() above. eval<StorageLayout::SOA>
+   * reads from a coefficient-major mirror of m_table (packed on first use) so
+   * each step of the Horner recurrence loads from a contiguous array instead
+   * of gathering through the AoS stride. Table semantics and the JSON
+   * contents are unchanged; the mirror costs one extra copy of the
+   * coefficients in memory. */
+  template <StorageLayout SL>
+  void eval(const TIN* xs, TOUT* out, std::size_t n) const {
+    FUNC_IF_CONSTEXPR(SL == StorageLayout::AOS){
+      eval(xs, out, n);
+      return;
+    }
+
+    /* entered once per batch (not per element) so the critical section is
+     * cheap, and its implied flushes make the lazy pack safe to race on */
+    #pragma omp critical(func_metatable_pack_soa)
+    {
+      if(!m_soaTable) pack_soa();
+    }
+    const TOUT* soa = m_soaTable.get();
+    const unsigned int stride = m_numTableEntries;
+
+    #pragma omp simd
+    for(std::size_t i=0; i<n; i++){
+      unsigned int x0; TIN dx;
+      FUNC_IF_CONSTEXPR(GT == GridTypes::UNIFORM){
+        dx = m_stepSize_inv*(xs[i]-m_minArg);
+        x0 = static_cast<unsigned int>(dx);
+        dx -= x0;
+      }else{
+        x0 = static_cast<unsigned int>(m_transferFunction.inverse(xs[i]));
+        dx = xs[i];
+      }
+
+      TOUT sum = soa[(N-1)*stride + x0];
+      for(unsigned int k=N-1; k>0; k--){
+        sum *= dx;
+        sum += soa[(k-1)*stride + x0];
+      }
+      out[i] = sum;
+    }
+  }
+
   /** \brief If LUT coefficients (of type TOUT) are callable, then apply each to `args` as soon as possible.
    *
    * Notes:
@@ -290,6 +814,17 @@ public:
     unsigned int x0; TIN dx;
     std::tie(x0,dx) = hash<GT>(x);
 
+#ifndef FUNC_NO_ESTRIN
+    FUNC_IF_CONSTEXPR(N >= 5){
+      /* apply each coefficient to args first, then combine with Estrin */
+      using sum_t = decltype(m_table[x0].coefs[0](args...));
+      sum_t vals[N];
+      for(unsigned int k=0; k<N; k++)
+        vals[k] = m_table[x0].coefs[k](args...);
+      return estrin_from_values<N>(vals, dx);
+    }
+#endif
+
     auto sum = m_table[x0].coefs[N-1](args...);
     for(unsigned int k=N-1; k>0; k--){
       sum *= dx;
@@ -302,6 +837,23 @@ public:
    * TODO make this function virtual and override in Pade and linear raw tables */
   TOUT diff(unsigned int s, TIN x) const {
     unsigned int x0; TIN dx;
+    /* use the precomputed derivative coefficients when available: same
+     * hash + Horner as operator() with no scaling work per call */
+    if(s >= 1u && s <= m_diffTables.size()){
+      std::tie(x0,dx) = hash<GT>(x);
+      const polynomial<TOUT,N>& p = m_diffTables[s-1][x0];
+#ifndef FUNC_NO_ESTRIN
+      FUNC_IF_CONSTEXPR(N >= 5)
+        return eval_estrin<N>(p, dx);
+#endif
+      TOUT sum = p.coefs[N-1];
+      for(unsigned int k=N-1; k>0; k--){
+        sum *= dx;
+        sum += p.coefs[k-1];
+      }
+      return sum;
+    }
+
     std::tie(x0,dx) = hash<GT>(x);
 
     auto sum = static_cast<TIN>(permutation(N-1,s))*m_table[x0].coefs[N-1];
@@ -384,11 +936,18 @@ void to_json(nlohmann::json& jsonStats, const MetaTable<N,TIN,TOUT,GT>& lut) {
   // things that are important for nonuniform tables:
   jsonStats["transfer_function_coefs"] = lut.transfer_function_coefs();
 
-  // save the polynomial coefs of each lookup table
-  // Note: m_order is used as the number of polynomial coefs
-  for(unsigned int i=0; i<lut.num_table_entries(); i++)
+  // save the polynomial coefs of each lookup table as an array of arrays.
+  // Older versions of FunC keyed every entry and coefficient with
+  // std::to_string(i) which made reading large tables O(n log n) string
+  // lookups; from_json still accepts that layout.
+  nlohmann::json table = nlohmann::json::array();
+  for(unsigned int i=0; i<lut.num_table_entries(); i++){
+    nlohmann::json coefs = nlohmann::json::array();
     for(unsigned int j=0; j<lut.ncoefs_per_entry(); j++)
-      jsonStats["table"][std::to_string(i)]["coefs"][std::to_string(j)] = lut.table_entry(i,j);
+      coefs.push_back(lut.table_entry(i,j));
+    table.push_back(std::move(coefs));
+  }
+  jsonStats["table"] = std::move(table);
 }
 
 template <unsigned int N, typename TIN, typename TOUT, GridTypes GT,
@@ -420,11 +979,24 @@ void from_json(const nlohmann::json& jsonStats, MetaTable<N,TIN,TOUT,GT>& lut) {
   jsonStats.at("numTableEntries").get_to(lut.m_numTableEntries);
   jsonStats.at("tableMaxArg").get_to(lut.m_tableMaxArg);
 
-  // Recompute m_table (the array of polynomials) and the transfer function
-  lut.m_table.reset(new polynomial<TOUT,N>[lut.m_numTableEntries]);
-  for(unsigned int i=0; i<lut.m_numTableEntries; i++)
-    for(unsigned int j=0; j<lut.ncoefs_per_entry(); j++)
-      jsonStats.at("table").at(std::to_string(i)).at("coefs").at(std::to_string(j)).get_to(lut.m_table[i].coefs[j]);
+  // Recompute m_table (the array of polynomials) and the transfer function.
+  // allocate_table assigns a fresh unique_ptr so any mmap state in the
+  // deleter is cleared if lut was previously backed by read_binary; the SoA
+  // mirror and any derivative tables belong to the old coefficients.
+  lut.allocate_table(lut.m_numTableEntries);
+  lut.m_soaTable.reset();
+  lut.m_diffTables.clear();
+  const nlohmann::json& table = jsonStats.at("table");
+  if(table.is_array()){
+    for(unsigned int i=0; i<lut.m_numTableEntries; i++)
+      for(unsigned int j=0; j<lut.ncoefs_per_entry(); j++)
+        table.at(i).at(j).get_to(lut.m_table[i].coefs[j]);
+  }else{
+    // tables written by older versions of FunC key each index with std::to_string
+    for(unsigned int i=0; i<lut.m_numTableEntries; i++)
+      for(unsigned int j=0; j<lut.ncoefs_per_entry(); j++)
+        table.at(std::to_string(i)).at("coefs").at(std::to_string(j)).get_to(lut.m_table[i].coefs[j]);
+  }
 
   // rebuild the transfer function
   lut.m_transferFunction = TransferFunction<TIN>(jsonStats["transfer_function_coefs"].get<std::array<TIN,4>>());
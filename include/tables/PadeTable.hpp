@@ -70,7 +70,7 @@ public:
       throw std::invalid_argument(m_name + " needs the " + std::to_string(N+M) + "th derivative but this was not provided in FunctionContainer");
 
     //m_grid.reset(new TIN[m_numTableEntries]);
-    m_table.reset(new polynomial<TOUT,M+N+1>[m_numTableEntries]);
+    allocate_table(m_numTableEntries);
     FUNC_BUILDPAR
     for (unsigned int ii=0;ii<m_numTableEntries;++ii) {
       /* nonuniform grids are not supported for PadeTables */
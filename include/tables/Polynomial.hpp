@@ -5,6 +5,8 @@
 
 #include <string>
 #include <ostream> // operator<<
+#include <cmath> // std::fma
+#include "config.hpp" // FUNC_IF_CONSTEXPR
 
 #pragma once
 
@@ -119,6 +121,63 @@ inline TOUT eval(polynomial<TOUT,N> p, TIN x){
 }
 
 
+/* fused multiply-add x*a + b. When the target actually has FMA instructions
+ * (__FMA__, eg. -mfma or -march=native on anything modern) the exact
+ * overloads use std::fma so contraction doesn't depend on -ffp-contract.
+ * Without the instruction std::fma is a correctly-rounded libm call -- far
+ * slower than a multiply-add -- so everything else stays a plain expression
+ * the compiler may contract */
+template <typename TIN, typename TOUT>
+inline TOUT fmadd(TIN x, TOUT a, TOUT b){ return x*a + b; }
+#ifdef __FMA__
+inline double fmadd(double x, double a, double b){ return std::fma(x,a,b); }
+inline float fmadd(float x, float a, float b){ return std::fma(x,a,b); }
+#endif
+
+/** \brief Evaluate a polynomial given its coefficient values with Estrin's
+ * scheme.
+ *
+ * Horner's method is a strict serial dependency chain: N-1 dependent
+ * multiply-adds. Estrin pairs coefficients level by level (c0+x*c1,
+ * c2+x*c3, ... then combines pairs with x^2, x^4, ...), so the tree has
+ * depth ~log2(N) and the FMA units work in parallel. Same operation count,
+ * results differ from Horner only by rounding association.
+ * \ingroup Polynomial */
+/* one level of the Estrin tree, recursing with a compile-time size so every
+ * level fully unrolls and the temporaries stay in registers */
+template <unsigned int M>
+struct estrin_level {
+  template <typename TOUT, typename TIN>
+  static inline TOUT eval(TOUT* t, TIN xp){
+    constexpr unsigned int half = M/2;
+    for(unsigned int i=0; i<half; i++)
+      t[i] = fmadd(xp, t[2*i+1], t[2*i]);
+    FUNC_IF_CONSTEXPR(M % 2 == 1)
+      t[half] = t[M-1]; // odd coefficient rides along to the next level
+    return estrin_level<(M+1)/2>::eval(t, xp*xp);
+  }
+};
+template <>
+struct estrin_level<1u> {
+  template <typename TOUT, typename TIN>
+  static inline TOUT eval(TOUT* t, TIN){ return t[0]; }
+};
+
+template <unsigned int N, typename TOUT, typename TIN = TOUT>
+inline TOUT estrin_from_values(TOUT (&t)[N], TIN x){
+  return estrin_level<N>::eval(t, x);
+}
+
+/** \brief Compute p(x) with Estrin's scheme (see estrin_from_values)
+ * \ingroup Polynomial */
+template <unsigned int N, typename TOUT, typename TIN = TOUT>
+inline TOUT eval_estrin(const polynomial<TOUT,N>& p, TIN x){
+  TOUT t[N];
+  for(unsigned int k=0; k<N; k++)
+    t[k] = p.coefs[k];
+  return estrin_from_values<N>(t, x);
+}
+
 /* convenient debugging method for printing a polynomial */
 template <unsigned int N, typename TOUT>
 std::string polynomial_print(const polynomial<TOUT,N>& p){
@@ -0,0 +1,114 @@
+/** \file RangeReductionTables.hpp
+ * \brief Range-reduction adapters layered over any LUT: wrap periodic
+ * arguments into one period, or fold symmetric/antisymmetric arguments about
+ * a symmetry point.
+ * \ingroup MetaTable
+ *
+ * Building a LUT over a function's full requested domain pays memory
+ * proportional to the range even when the function repeats or mirrors
+ * itself. A table over one period (or one half of a symmetric domain) is
+ * correspondingly smaller and far more likely to stay L2 resident; these
+ * adapters add the few FLOPs of reduction in front of the wrapped table's
+ * usual hash.
+ *
+ * Usage example:
+ * \code{.cpp}
+ *   // f has period 2pi: table over [0,2pi), evaluate anywhere
+ *   PeriodicTable<UniformChebyInterpTable<3,double>> P(fc, {0.0, 2*pi, 1e-3});
+ *   double val = P(123.456);
+ *
+ *   // f is odd about 0: table over [0,b], evaluate on [-b,b]
+ *   EvenOddTable<UniformChebyInterpTable<3,double>, Symmetry::ODD> S(fc, {0.0, b, 1e-3});
+ *   double val2 = S(-0.3);
+ * \endcode
+ *
+ * Notes:
+ * - Like FailureProofTable, these are templated on the concrete table type
+ *   so the wrapped hash+Horner stays inlinable (not factory-registered).
+ * - The wrapped table is built over exactly the parameters given; the
+ *   adapter only transforms arguments.
+ */
+#pragma once
+#include "LookupTable.hpp"
+#include <cmath> // floor, abs
+#include <limits> // infinity
+#include <string>
+
+namespace func {
+
+/** \brief Evaluate a LUT built over one period [a,b) at any argument by
+ * wrapping x into the period first (one multiply + floor + fma). */
+template <class LUT_TYPE>
+class PeriodicTable final : public LookupTable<typename LUT_TYPE::input_type, typename LUT_TYPE::output_type> {
+  using TIN = typename LUT_TYPE::input_type;
+  using TOUT = typename LUT_TYPE::output_type;
+
+  LUT_TYPE m_LUT;
+  TIN m_period, m_period_inv, m_left;
+
+public:
+  PeriodicTable(const FunctionContainer<TIN,TOUT>& fc, const LookupTableParameters<TIN>& par) :
+    m_LUT(fc, par), m_period(par.maxArg - par.minArg),
+    m_period_inv(static_cast<TIN>(1.0)/(par.maxArg - par.minArg)), m_left(par.minArg) {}
+
+  TOUT operator()(TIN x) const final {
+    using std::floor;
+    x = x - m_period*floor((x - m_left)*m_period_inv);
+    return m_LUT(x);
+  }
+
+  std::string name() const final { return std::string("Periodic<") + m_LUT.name() + ">"; }
+  /* periodic extension is defined everywhere */
+  TIN min_arg() const final { return -std::numeric_limits<TIN>::infinity(); }
+  TIN max_arg() const final { return std::numeric_limits<TIN>::infinity(); }
+  unsigned int order() const final { return m_LUT.order(); }
+  std::size_t size() const final { return m_LUT.size(); }
+  unsigned int num_subintervals() const final { return m_LUT.num_subintervals(); }
+  TIN step_size() const final { return m_LUT.step_size(); }
+  std::pair<TIN,TIN> bounds_of_subinterval(unsigned int intervalNumber) const final { return m_LUT.bounds_of_subinterval(intervalNumber); }
+  void print_json(std::ostream& out) const final { m_LUT.print_json(out); }
+
+  /** the period's left endpoint (arguments are wrapped into [left, left+period)) */
+  TIN period_left() const { return m_left; }
+  TIN period() const { return m_period; }
+};
+
+enum class Symmetry {EVEN, ODD};
+
+/** \brief Evaluate a LUT built over [c,b] (c the symmetry point) on the
+ * mirrored domain [2c-b, b] by folding x about c, flipping the sign of the
+ * result for odd functions. */
+template <class LUT_TYPE, Symmetry SYM>
+class EvenOddTable final : public LookupTable<typename LUT_TYPE::input_type, typename LUT_TYPE::output_type> {
+  using TIN = typename LUT_TYPE::input_type;
+  using TOUT = typename LUT_TYPE::output_type;
+
+  LUT_TYPE m_LUT;
+  TIN m_center; //!< the symmetry point (the wrapped table's left endpoint)
+
+public:
+  EvenOddTable(const FunctionContainer<TIN,TOUT>& fc, const LookupTableParameters<TIN>& par) :
+    m_LUT(fc, par), m_center(par.minArg) {}
+
+  TOUT operator()(TIN x) const final {
+    using std::abs;
+    TOUT y = m_LUT(m_center + abs(x - m_center));
+    FUNC_IF_CONSTEXPR(SYM == Symmetry::ODD)
+      return x < m_center ? -y : y;
+    return y;
+  }
+
+  std::string name() const final {
+    return std::string(SYM == Symmetry::ODD ? "Odd<" : "Even<") + m_LUT.name() + ">";
+  }
+  TIN min_arg() const final { return 2*m_center - m_LUT.max_arg(); }
+  TIN max_arg() const final { return m_LUT.max_arg(); }
+  unsigned int order() const final { return m_LUT.order(); }
+  std::size_t size() const final { return m_LUT.size(); }
+  unsigned int num_subintervals() const final { return m_LUT.num_subintervals(); }
+  TIN step_size() const final { return m_LUT.step_size(); }
+  std::pair<TIN,TIN> bounds_of_subinterval(unsigned int intervalNumber) const final { return m_LUT.bounds_of_subinterval(intervalNumber); }
+  void print_json(std::ostream& out) const final { m_LUT.print_json(out); }
+};
+
+} // namespace func
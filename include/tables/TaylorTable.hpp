@@ -49,7 +49,7 @@ public:
       throw std::invalid_argument(m_name+" needs the " + std::to_string(N) + "th derivative but this is not defined");
 
     /* Allocate and set table */
-    m_table.reset(new polynomial<TOUT,N+1>[m_numTableEntries]);
+    allocate_table(m_numTableEntries);
     FUNC_BUILDPAR
     for (unsigned int ii=0; ii<m_numTableEntries-1; ++ii) {
       TIN x = m_minArg + ii*m_stepSize;
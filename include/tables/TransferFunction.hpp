@@ -3,6 +3,7 @@
 #include <cmath> // sqrt
 #include <limits> // std::numeric_limits<T>::digits
 #include <array> // std::array
+#include <vector> // usage histograms
 #include <utility> // std::pair
 #include <type_traits>
 
@@ -59,6 +60,29 @@ class TransferFunction
   /* This class is a polynomial approximating g inverse.
    * The identity transfer function is {-m_minArg/m_stepSize,1/m_stepSize,0,0} */
   __attribute__((aligned)) std::array<TIN,4> m_inverse_coefs = {{0,0,0,0}};
+
+  /* Build m_inverse_coefs as the monotone Hermite cubic p with p(a)=a,
+   * p(b)=b, p'(a)=m0, p'(b)=m1 (symbolic expression computed by Matlab),
+   * then bake the underlying table's hash into the coefficients. Both
+   * constructors funnel through here. */
+  void set_hermite_coefs(TIN a, TIN b, TIN m0, TIN m1){
+    /* Ensure monotonicity of the Hermite interpolating polynomial. Note that m0,m1 >= 0.
+     * TODO this is sufficient to ensure p is monotone, but it's not necessary. Figure out how to allow m0>3 or m1>3. */
+    m0 = (m0 > 3) ? 3 : m0;
+    m1 = (m1 > 3) ? 3 : m1;
+
+    m_inverse_coefs[0] = (a*b*(a + b - a*m1 - b*m0))/(a - b)/(a - b);
+    m_inverse_coefs[1] = (a*a*m1 - 6*a*b + b*b*m0 + 2*a*b*m0 + 2*a*b*m1)/(a - b)/(a - b);
+    m_inverse_coefs[2] = -(a*m0 - 3*b - 3*a + 2*a*m1 + 2*b*m0 + b*m1)/(a - b)/(a - b);
+    m_inverse_coefs[3] = (m0 + m1 - 2)/(a - b)/(a - b);
+
+    /* build the inverse function that we'll actually use by encoding the underlying table's hash into
+     * the transfer function eval. This way, the only cost of using a transfer function is 4 stack IOPs and 6 FLOPs */
+    m_inverse_coefs[0] = m_inverse_coefs[0] - m_minArg;
+    for(unsigned int i=0; i<4; i++)
+      m_inverse_coefs[i] = m_inverse_coefs[i] / m_stepSize;
+  }
+
 public:
   /* Set m_inverse_coefs equal to a vector that came from a json file (or TODO from a LookupTableParameters object) */
   TransferFunction(const std::array<TIN,4>& inv_coefs) { m_inverse_coefs = inv_coefs; }
@@ -117,25 +141,41 @@ public:
     TIN m0 = 1/g_prime(a);
     TIN m1 = 1/g_prime(b);
 
-    /* Ensure monotonicity of the Hermite interpolating polynomial. Note that m0,m1 >= 0.
-     * TODO this is sufficient to ensure p is monotone, but it's not necessary. Figure out how to allow m0>3 or m1>3. */
-    m0 = (m0 > 3) ? 3 : m0;
-    m1 = (m1 > 3) ? 3 : m1;
+    set_hermite_coefs(a, b, m0, m1);
+#endif
+  }
 
-    /* Compute the Hermite interpolating polynomial p for g_inv satisfying
-     * p(a)=a, p(b)=b, p'(a)=m0, p'(b)=m1
-     * (this symbolic expression was computed by Matlab) */
-    m_inverse_coefs[0] = (a*b*(a + b - a*m1 - b*m0))/(a - b)/(a - b);
-    m_inverse_coefs[1] = (a*a*m1 - 6*a*b + b*b*m0 + 2*a*b*m0 + 2*a*b*m1)/(a - b)/(a - b);
-    m_inverse_coefs[2] = -(a*m0 - 3*b - 3*a + 2*a*m1 + 2*b*m0 + b*m1)/(a - b)/(a - b);
-    m_inverse_coefs[3] = (m0 + m1 - 2)/(a - b)/(a - b);
+  /** \brief Build a transfer function from an observed-usage histogram
+   * (eg. ArgumentRecord's) instead of the function's derivative.
+   *
+   * The derivative-based constructor above equidistributes approximation
+   * error; this one concentrates subintervals where the caller actually
+   * evaluates. We want g_inv'(x) proportional to the observed density w(x)
+   * with mean 1 over [a,b], and (as above) a monotone cubic can only match
+   * that at the endpoints, so the histogram densities at a and b become the
+   * Hermite slopes. The same monotonicity clamp and hash-baking scaling
+   * apply, and an empty histogram yields the identity transfer function. */
+  TransferFunction(const std::vector<unsigned int>& hist, TIN histMin, TIN histMax,
+      TIN minArg, TIN tableMaxArg, TIN stepSize) :
+    m_minArg(minArg), m_tableMaxArg(tableMaxArg), m_stepSize(stepSize) {
+    TIN a = m_minArg;
+    TIN b = m_tableMaxArg;
 
-    /* build the inverse function that we'll actually use by encoding the underlying table's hash into
-     * the transfer function eval. This way, the only cost of using a transfer function is 4 stack IOPs and 6 FLOPs */
-    m_inverse_coefs[0] = m_inverse_coefs[0] - m_minArg;
-    for(unsigned int i=0; i<4; i++)
-      m_inverse_coefs[i] = m_inverse_coefs[i] / m_stepSize;
-#endif
+    /* density of recorded args at x, normalized so it integrates to 1 over [a,b] */
+    unsigned long total = 0;
+    for(auto c : hist) total += c;
+    auto density = [&](TIN x) -> TIN {
+      if(hist.empty() || total == 0 || !(histMax > histMin)) return static_cast<TIN>(1.0)/(b-a);
+      TIN t = (x - histMin)/(histMax - histMin)*static_cast<TIN>(hist.size());
+      std::size_t i = t <= TIN(0) ? 0 : (t >= static_cast<TIN>(hist.size()-1u) ? hist.size()-1u : static_cast<std::size_t>(t));
+      TIN bucket_width = (histMax - histMin)/static_cast<TIN>(hist.size());
+      return static_cast<TIN>(hist[i])/(static_cast<TIN>(total)*bucket_width);
+    };
+
+    TIN m0 = (b-a)*density(a);
+    TIN m1 = (b-a)*density(b);
+
+    set_hermite_coefs(a, b, m0, m1);
   }
 
   /* Horner's method */
@@ -3,8 +3,13 @@
  * \brief This group of classes all implement MetaTable for a fast approximation to a user's mathematical function */
 #pragma once
 #include "ChebyInterpTable.hpp"
+#include "CompressedTable.hpp"
 #include "CubicHermiteTable.hpp"
 #include "ExactInterpTable.hpp"
+#include "FixedGeometryTable.hpp"
+#include "Flat2DTable.hpp"
+#include "FusedTable.hpp"
 #include "LinearRawInterpTable.hpp"
 #include "PadeTable.hpp"
+#include "RangeReductionTables.hpp"
 #include "TaylorTable.hpp"
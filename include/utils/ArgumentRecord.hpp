@@ -21,6 +21,9 @@
 #include <fstream>
 #include <limits> // numeric_limits<TIN>::max() / lowest()
 #include <cmath> // pow, floor, ceil
+#include <cstdint> // uint64_t trace header
+#include <atomic> // relaxed shard counters
+#include <stdexcept> // write_trace errors
 #include "json.hpp"
 
 namespace func {
@@ -84,11 +87,28 @@ public:
 template <typename TIN>
 class ArgumentRecord
 {
-  // Histogram used to record locations of function evaluations
-  // and other helper helper vars
-  std::vector<unsigned int> mv_histogram;
-  std::vector<FuncMutex>    mv_histogram_mutex;
-  unsigned int              m_histSize;
+  /* Each thread records into its own cache-line-aligned shard so the hot
+   * record_arg path takes no locks at all (the old implementation serialized
+   * every recorded argument through a FuncMutex per bucket plus several
+   * omp critical sections, which slowed 64-thread runs enough to make
+   * FUNC_DEBUG unusable in production). Shards are only combined when a
+   * statistic is read. The counters are relaxed atomics because distinct
+   * threads can land on one shard (thread count raised after construction,
+   * or nested teams whose thread numbers restart at 0): sharding makes that
+   * rare, the atomics make it correct. The trace buffer cannot be atomic so
+   * it takes the shard's mutex, uncontended whenever threads have their own
+   * shard. */
+  struct alignas(64) Shard {
+    std::vector<std::atomic<unsigned int>> histogram;
+    std::atomic<unsigned int> num_out_of_bounds;
+    std::atomic<TIN> max_recorded;
+    std::atomic<TIN> min_recorded;
+    std::vector<TIN> trace; //!< raw argument sequence (only filled while tracing)
+    mutable FuncMutex trace_mutex;
+  };
+  mutable std::vector<Shard> mv_shards;
+  unsigned int m_histSize;
+  std::size_t m_traceCapacity = 0; //!< 0 = tracing off
 
   std::ostream* mp_streamer;
 
@@ -96,33 +116,68 @@ class ArgumentRecord
   TIN m_minArg;
   TIN m_maxArg;
 
-  /* vars containing any statistics */
-  // the index of the bucket with the largest count
-  unsigned int m_peak_index;
+  /* everything derivable from the shards, combined on read */
+  struct MergedRecord {
+    std::vector<unsigned int> histogram;
+    unsigned int num_out_of_bounds;
+    unsigned int peak_index;
+    TIN max_recorded;
+    TIN min_recorded;
+  };
+
+  MergedRecord merge() const {
+    MergedRecord m;
+    m.histogram = std::vector<unsigned int>(m_histSize, 0);
+    m.num_out_of_bounds = 0;
+    m.peak_index = 0;
+    m.max_recorded = std::numeric_limits<TIN>::lowest();
+    m.min_recorded = std::numeric_limits<TIN>::max();
+    for(const Shard& s : mv_shards){
+      for(unsigned int i=0; i<m_histSize; i++)
+        m.histogram[i] += s.histogram[i].load(std::memory_order_relaxed);
+      m.num_out_of_bounds += s.num_out_of_bounds.load(std::memory_order_relaxed);
+      TIN shard_max = s.max_recorded.load(std::memory_order_relaxed);
+      TIN shard_min = s.min_recorded.load(std::memory_order_relaxed);
+      if(shard_max > m.max_recorded) m.max_recorded = shard_max;
+      if(shard_min < m.min_recorded) m.min_recorded = shard_min;
+    }
+    for(unsigned int i=0; i<m_histSize; i++)
+      if(m.histogram[i] > m.histogram[m.peak_index])
+        m.peak_index = i;
+    return m;
+  }
 
-  // the number of elements outside the histogram's range
-  unsigned int m_num_out_of_bounds;
+  /* the shard this thread records into */
+  Shard& my_shard() const {
+#ifdef _OPENMP
+    return mv_shards[static_cast<unsigned int>(omp_get_thread_num()) % mv_shards.size()];
+#else
+    return mv_shards[0];
+#endif
+  }
 
-  // Record the extreme args to help the user
-  // decide what bounds to use for their tables
-  TIN m_max_recorded;
-  TIN m_min_recorded;
+  void init_shards(){
+#ifdef _OPENMP
+    unsigned int nshards = static_cast<unsigned int>(omp_get_max_threads());
+#else
+    unsigned int nshards = 1u;
+#endif
+    mv_shards = std::vector<Shard>(nshards);
+    for(Shard& s : mv_shards){
+      s.histogram = std::vector<std::atomic<unsigned int>>(m_histSize);
+      for(unsigned int i=0; i<m_histSize; i++)
+        s.histogram[i].store(0, std::memory_order_relaxed);
+      s.num_out_of_bounds.store(0, std::memory_order_relaxed);
+      s.max_recorded.store(std::numeric_limits<TIN>::lowest(), std::memory_order_relaxed);
+      s.min_recorded.store(std::numeric_limits<TIN>::max(), std::memory_order_relaxed);
+    }
+  }
 
   public:
     ArgumentRecord(TIN min, TIN max, unsigned int histSize, std::ostream* streamer) :
-      m_minArg(min), m_maxArg(max), m_histSize(histSize), mp_streamer(streamer)
+      m_histSize(histSize), mp_streamer(streamer), m_minArg(min), m_maxArg(max)
     {
-      /* Variables needed for recording function arguments.
-       * Init the entire histogram to 0 & increment later */
-      mv_histogram = std::vector<unsigned int>(histSize, 0);
-      // make a mutex for each bucket in the histogram
-      mv_histogram_mutex = std::vector<FuncMutex>(histSize);
-
-      // naive initial member arg values
-      m_peak_index = 0;
-      m_num_out_of_bounds = 0;
-      m_max_recorded = std::numeric_limits<TIN>::lowest();
-      m_min_recorded = std::numeric_limits<TIN>::max();
+      init_shards();
     }
 
     /* make the specific stream printed to depend on a printing function */
@@ -137,54 +192,37 @@ class ArgumentRecord
       m_maxArg = jsonStats["ArgumentRecord"]["maxArg"].get<TIN>();
 
       m_histSize = jsonStats["ArgumentRecord"]["histogramSize"].get<unsigned int>();
+      init_shards();
+      /* everything from the file lands in shard 0 */
       for(unsigned int i=0; i<m_histSize; i++)
-        mv_histogram[i] = jsonStats["ArgumentRecord"]["histogram"][std::to_string(i)].get<unsigned int>();
-      // reconstruct each of the histogram's mutexes
-      mv_histogram_mutex = std::vector<FuncMutex>(m_histSize);
-
-      m_peak_index   = jsonStats["ArgumentRecord"]["peak_index"].get<unsigned int>();
-      m_max_recorded = jsonStats["ArgumentRecord"]["m_max_recorded"].get<TIN>();
-      m_min_recorded = jsonStats["ArgumentRecord"]["m_min_recorded"].get<TIN>();
+        mv_shards[0].histogram[i].store(jsonStats["ArgumentRecord"]["histogram"][std::to_string(i)].get<unsigned int>(), std::memory_order_relaxed);
+      mv_shards[0].max_recorded.store(jsonStats["ArgumentRecord"]["m_max_recorded"].get<TIN>(), std::memory_order_relaxed);
+      mv_shards[0].min_recorded.store(jsonStats["ArgumentRecord"]["m_min_recorded"].get<TIN>(), std::memory_order_relaxed);
+      mp_streamer = nullptr;
     }
 
-    /* place x in the histogram. Mimic pipeline parallelism for any statistics with only one instance */
+    /* place x in this thread's shard: no locks, no shared writes */
     void record_arg(TIN x)
     {
+      Shard& shard = my_shard();
+      if(m_traceCapacity != 0){
+        FuncScopedLock lock(shard.trace_mutex);
+        if(shard.trace.size() < m_traceCapacity)
+          shard.trace.push_back(x);
+      }
       // Record x if it's within our histogram's limits
       if(m_minArg <= x && x <= m_maxArg){
         int x_index = COMPUTE_INDEX(x);
-
-        // manually lock bucket x_index until we leave this scope
-        FuncScopedLock lock(mv_histogram_mutex[x_index]);
-        mv_histogram[x_index]++;
-
-        /* TODO using critical sections is problematic design because only one
-         * ArgumentRecord instance can access some specific critical section code at a time.
-         * Use a scoped lock instead */
-        #pragma omp critical(func_argrecord1)
-        {
-          if(mv_histogram[x_index] > mv_histogram[m_peak_index]){
-            m_peak_index = x_index;
-          }
-        }
-
+        shard.histogram[x_index].fetch_add(1, std::memory_order_relaxed);
       }else{
         // x is out of bounds
-        #pragma omp critical(func_argrecord2)
-        m_num_out_of_bounds++;
+        shard.num_out_of_bounds.fetch_add(1, std::memory_order_relaxed);
       }
 
-      #pragma omp critical(func_argrecord3)
-      {
-        if(m_max_recorded < x)
-          m_max_recorded = x;
-      }
-
-      #pragma omp critical(func_argrecord4)
-      {
-        if(x < m_min_recorded)
-          m_min_recorded = x;
-      }
+      TIN prev_max = shard.max_recorded.load(std::memory_order_relaxed);
+      while(prev_max < x && !shard.max_recorded.compare_exchange_weak(prev_max, x, std::memory_order_relaxed)){}
+      TIN prev_min = shard.min_recorded.load(std::memory_order_relaxed);
+      while(x < prev_min && !shard.min_recorded.compare_exchange_weak(prev_min, x, std::memory_order_relaxed)){}
 
       // record more statistics here
     }
@@ -211,8 +249,9 @@ class ArgumentRecord
     // make a string representation of the histogram
     std::string to_string() const
     {
+      MergedRecord m = merge();
       // avoid division by zero by printing nothing if the histogram is empty
-      if(mv_histogram[m_peak_index]==0)
+      if(m.histogram[m.peak_index]==0)
         return "";
       
       // print out the histogram horizontally such that
@@ -221,12 +260,12 @@ class ArgumentRecord
       std::string hist_str;
       hist_str=to_string_with_precision(m_minArg,3)+'\n';
       for(unsigned int i=0; i<m_histSize; i++){
-        unsigned int row_length = ceil(15*mv_histogram[i]/mv_histogram[m_peak_index]);
+        unsigned int row_length = ceil(15*m.histogram[i]/m.histogram[m.peak_index]);
         for(unsigned int j=0; j<row_length; j++)
           hist_str=hist_str+'*';
         for(unsigned int j=row_length; j<15; j++)
           hist_str=hist_str+' ';
-        hist_str=hist_str + " " + ith_interval(i) + " with " + std::to_string(mv_histogram[i]) + " evaluations\n";
+        hist_str=hist_str + " " + ith_interval(i) + " with " + std::to_string(m.histogram[i]) + " evaluations\n";
       }
       hist_str=hist_str+to_string_with_precision(m_maxArg,3);
       return hist_str;
@@ -235,15 +274,16 @@ class ArgumentRecord
     // print each field in this class to the given ostream
     void print_json(nlohmann::json& jsonStats) const
     {
+      MergedRecord m = merge();
       jsonStats["ArgumentRecord"]["_comment"] = "Histogram of function evaluations.";
       jsonStats["ArgumentRecord"]["minArg"] = m_minArg;
       jsonStats["ArgumentRecord"]["maxArg"] = m_maxArg;
       jsonStats["ArgumentRecord"]["histogramSize"] = m_histSize;
       for(unsigned int i=0; i<m_histSize; i++)
-        jsonStats["ArgumentRecord"]["histogram"][std::to_string(i)]=mv_histogram[i];
-      jsonStats["ArgumentRecord"]["peak_index"] = m_peak_index;
-      jsonStats["ArgumentRecord"]["m_min_recorded"] = m_min_recorded;
-      jsonStats["ArgumentRecord"]["m_max_recorded"] = m_max_recorded;
+        jsonStats["ArgumentRecord"]["histogram"][std::to_string(i)]=m.histogram[i];
+      jsonStats["ArgumentRecord"]["peak_index"] = m.peak_index;
+      jsonStats["ArgumentRecord"]["m_min_recorded"] = m.min_recorded;
+      jsonStats["ArgumentRecord"]["m_max_recorded"] = m.max_recorded;
       
       // insert more statistics here
     }
@@ -251,24 +291,59 @@ class ArgumentRecord
   TIN min_arg() const { return m_minArg; }
   TIN max_arg() const { return m_maxArg; }
 
-  /* TODO use a standard algorithm */
+  /* the merged histogram, eg. for LookupTableParameters::usage_histogram */
+  std::vector<unsigned int> histogram() const { return merge().histogram; }
+
+  /** \brief Also capture the raw argument sequence (up to maxSamplesPerThread
+   * per thread) so it can be replayed by LookupTableComparator::use_trace.
+   * Appends into per-thread shards, so recording stays lock-free; each
+   * thread's order is preserved exactly, threads are concatenated. */
+  void enable_tracing(std::size_t maxSamplesPerThread){
+    m_traceCapacity = maxSamplesPerThread;
+    for(Shard& s : mv_shards)
+      s.trace.reserve(maxSamplesPerThread < 4096u ? maxSamplesPerThread : 4096u);
+  }
+
+  /** \brief Write the captured trace as a compact binary file:
+   * "FunCTRC1", a uint64 sizeof(TIN), a uint64 count, then count raw TIN
+   * values (the element size lets readers reject a mismatched TIN). */
+  void write_trace(const std::string& filename) const {
+    std::uint64_t count = 0;
+    for(const Shard& s : mv_shards){
+      FuncScopedLock lock(s.trace_mutex);
+      count += s.trace.size();
+    }
+    std::ofstream out(filename, std::ios::binary);
+    out.write("FunCTRC1", 8);
+    const std::uint64_t elem_size = sizeof(TIN);
+    out.write(reinterpret_cast<const char*>(&elem_size), sizeof(elem_size));
+    out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    for(const Shard& s : mv_shards){
+      FuncScopedLock lock(s.trace_mutex);
+      out.write(reinterpret_cast<const char*>(s.trace.data()), s.trace.size()*sizeof(TIN));
+    }
+    if(!out)
+      throw std::invalid_argument("Error in func::ArgumentRecord.write_trace: could not write to " + filename);
+  }
+
   unsigned int total_recorded() const {
+    MergedRecord m = merge();
     unsigned int t = 0;
     for(unsigned int i=0; i<m_histSize; i++)
-      t += mv_histogram[i];
+      t += m.histogram[i];
     return t;
   }
   
   /* the index of the bucket with the largest count */
-  unsigned int index_of_peak() const { return m_peak_index; }
-  unsigned int peak() const { return mv_histogram[m_peak_index]; }
+  unsigned int index_of_peak() const { return merge().peak_index; }
+  unsigned int peak() const { MergedRecord m = merge(); return m.histogram[m.peak_index]; }
 
   /* the number of elements outside the histogram's range */
-  unsigned int num_out_of_bounds() const { return m_num_out_of_bounds; }
+  unsigned int num_out_of_bounds() const { return merge().num_out_of_bounds; }
 
   /* Return the extreme args to help the user decide what bounds to use for their LUTs */
-  TIN max_recorded() const { return m_max_recorded; }
-  TIN min_recorded() const { return m_min_recorded; }
+  TIN max_recorded() const { return merge().max_recorded; }
+  TIN min_recorded() const { return merge().min_recorded; }
 };
 
 
@@ -12,8 +12,11 @@
   inside a std::initializer_list
   - static data after constructor has been called
   - evaluate by using parentheses, just like a function
-  - operator() caches the most recently used LUT and skips the binary search when repeatedly evaluating from the same table's range
-  - 
+  - operator() keeps a per-thread cache of the most recently used LUT and
+  skips the binary search when repeatedly evaluating from the same table's
+  range. There is no shared mutable state, so evaluation never serializes
+  threads (an older implementation guarded one shared MRU pointer with
+  omp critical and scaled horribly)
 
 
   TODO this class should support to/from_json. We could use the unique_ptr<LookupTable> version of from_json in LookupTableFactory
@@ -21,11 +24,11 @@
 #pragma once
 #include "LookupTable.hpp"
 #include "LookupTableGenerator.hpp"
-#include <map> // store LUTs
-#include <vector> // arguments to ctor are vectors
+#include <vector> // arguments to ctor are vectors (and subtables are stored in vectors)
 #include <memory> // shared_ptr
 #include <utility> // std::tuple
 #include <stdexcept> // invalid_argument
+#include <algorithm> // upper_bound, sort, min_element
 #include <numeric>
 
 
@@ -33,13 +36,56 @@ namespace func {
 
 template <typename TIN, typename TOUT = TIN>
 class CompositeLookupTable final : public LookupTable<TIN,TOUT> {
-  // collection of FunC lookup tables used to sample from
-  using lookup_map_t = std::map<TIN,std::shared_ptr<LookupTable<TIN,TOUT>>>;
-  lookup_map_t m_lutmap;
-  mutable std::shared_ptr<LookupTable<TIN,TOUT>> recentLUT;
+  /* collection of FunC lookup tables used to sample from, sorted by right
+   * endpoint. m_breakpoints[k] is the right endpoint of m_luts[k] so dispatch
+   * is one branchless binary search over a flat contiguous array instead of
+   * pointer-chasing a tree */
+  std::vector<TIN> m_breakpoints;
+  std::vector<std::shared_ptr<LookupTable<TIN,TOUT>>> m_luts;
   std::function<TOUT(TIN)> m_fun;
   //LookupTableFactory<TIN,TOUT> factory; TODO might be useful for building a CompositeTable from a file...
 
+  /* Precomputed O(1) dispatch index: a uniform grid over [min_arg,max_arg]
+   * where m_dispatch[c] is the index of the first subtable whose right
+   * endpoint is greater than the left edge of cell c. Dispatch is then one
+   * multiply + one array load (like MetaTable's own uniform hash), plus at
+   * most a few advances when a cell straddles breakpoints. */
+  std::vector<unsigned int> m_dispatch;
+  TIN m_dispatchMin;
+  TIN m_dispatchStepInv;
+
+  void build_dispatch_grid(unsigned int cells_per_subtable = 16u){
+    m_dispatchMin = m_luts.front()->min_arg();
+    TIN width = m_breakpoints.back() - m_dispatchMin;
+    if(!(width > static_cast<TIN>(0.0)))
+      return; // degenerate domain: operator() falls back to the binary search
+
+    unsigned int ncells = cells_per_subtable*static_cast<unsigned int>(m_luts.size());
+    m_dispatchStepInv = ncells/width;
+    m_dispatch.resize(ncells);
+    for(unsigned int c=0; c<ncells; c++){
+      TIN lo = m_dispatchMin + c*width/ncells;
+      m_dispatch[c] = static_cast<unsigned int>(
+          std::upper_bound(m_breakpoints.cbegin(), m_breakpoints.cend(), lo) - m_breakpoints.cbegin());
+    }
+  }
+
+  /* sort subtables by right endpoint (ctor args may come in any order) */
+  void sort_subtables(){
+    std::vector<unsigned int> idx(m_luts.size());
+    std::iota(idx.begin(), idx.end(), 0u);
+    std::sort(idx.begin(), idx.end(),
+        [this](unsigned int a, unsigned int b){ return m_breakpoints[a] < m_breakpoints[b]; });
+    std::vector<TIN> breaks; breaks.reserve(idx.size());
+    std::vector<std::shared_ptr<LookupTable<TIN,TOUT>>> luts; luts.reserve(idx.size());
+    for(auto i : idx){
+      breaks.push_back(m_breakpoints[i]);
+      luts.push_back(std::move(m_luts[i]));
+    }
+    m_breakpoints = std::move(breaks);
+    m_luts = std::move(luts);
+  }
+
 public:
   /* vector of n table names, a vector of n step sizes, and a vector of n pairs.
    * Order of names determines which tables are used on which subintervals */
@@ -52,17 +98,30 @@ public:
     /* TODO we could check that each LUT is over distinct intervals, but that'll probably require setting an order for name_l_r_steps
      * and it's probably not that bad if the output from operator() is not unique for each input */
 
-    /* -- build each of the given LUTs -- */
-    for(auto&& name_l_r_step : name_l_r_steps){
-      std::string name; TIN left, right, step;
-      std::tie(name, left, right, step) = name_l_r_step;
-
-      double N = std::ceil((right-left)/step);
-      LookupTableGenerator<TIN,TOUT> gen(func_container, left, right);
-      m_lutmap.insert({right, std::move(gen.generate_by_step(name, (right-left)/N))});
+    /* -- build each of the given LUTs, concurrently: subtables are
+     * independent so startup scales with cores. Exceptions cannot cross the
+     * parallel region so the first one is stashed and rethrown -- */
+    m_breakpoints.resize(name_l_r_steps.size());
+    m_luts.resize(name_l_r_steps.size());
+    std::exception_ptr first_error = nullptr;
+    #pragma omp parallel for schedule(dynamic)
+    for(std::size_t k=0; k<name_l_r_steps.size(); k++){
+      try{
+        std::string name; TIN left, right, step;
+        std::tie(name, left, right, step) = name_l_r_steps[k];
+
+        double N = std::ceil((right-left)/step);
+        LookupTableGenerator<TIN,TOUT> gen(func_container, left, right);
+        m_breakpoints[k] = right;
+        m_luts[k] = gen.generate_by_step(name, (right-left)/N);
+      }catch(...){
+        #pragma omp critical(func_composite_ctor)
+        if(!first_error) first_error = std::current_exception();
+      }
     }
-    /* initialize the cached LUT */
-    recentLUT = m_lutmap.cbegin()->second;
+    if(first_error) std::rethrow_exception(first_error);
+    sort_subtables();
+    build_dispatch_grid();
   }
 
   CompositeLookupTable(const FunctionContainer<TIN,TOUT>& func_container, const std::vector<std::tuple<std::string,TIN,TIN,TIN,TIN>>& name_l_r_atol_rtols) :
@@ -71,41 +130,66 @@ public:
     if(m_fun == nullptr)
       throw std::invalid_argument("Error in func::CompositeLUT: given a null func::FunctionContainer.");
 
-    /* -- build each of the given LUTs -- */
-    for(auto&& name_l_r_atol_rtol : name_l_r_atol_rtols){
-      std::string name; TIN left, right, atol, rtol;
-      std::tie(name, left, right, atol, rtol) = name_l_r_atol_rtol;
-
-      LookupTableGenerator<TIN,TOUT> gen(func_container, left, right);
-      unsigned int N = gen.generate_by_tol(name, atol, rtol)->num_subintervals();
-      m_lutmap.insert({right, std::move(gen.generate_by_step(name, (right-left)/static_cast<double>(N) ))});
+    /* -- build each of the given LUTs, concurrently. The tolerance search's
+     * result is used directly: the old implementation regenerated each table
+     * a second time with generate_by_step even though generate_by_tol already
+     * returns the table built at the winning step size -- */
+    m_breakpoints.resize(name_l_r_atol_rtols.size());
+    m_luts.resize(name_l_r_atol_rtols.size());
+    std::exception_ptr first_error = nullptr;
+    #pragma omp parallel for schedule(dynamic)
+    for(std::size_t k=0; k<name_l_r_atol_rtols.size(); k++){
+      try{
+        std::string name; TIN left, right, atol, rtol;
+        std::tie(name, left, right, atol, rtol) = name_l_r_atol_rtols[k];
+
+        LookupTableGenerator<TIN,TOUT> gen(func_container, left, right);
+        m_breakpoints[k] = right;
+        m_luts[k] = gen.generate_by_tol(name, atol, rtol);
+      }catch(...){
+        #pragma omp critical(func_composite_ctor)
+        if(!first_error) first_error = std::current_exception();
+      }
     }
-    /* initialize the cached LUT */
-    recentLUT = m_lutmap.cbegin()->second;
+    if(first_error) std::rethrow_exception(first_error);
+    sort_subtables();
+    build_dispatch_grid();
   }
 
   ~CompositeLookupTable(){}
 
   TOUT operator()(TIN x) const final
   {
-    /* check if x is within the bounds of the most recently used LUT (in a threadsafe way) */
-    std::shared_ptr<LookupTable<TIN,TOUT>> localrecentLUT;
-    #pragma omp critical(diedie)
-    {
-    localrecentLUT = recentLUT;
+    /* check if x is within the bounds of this thread's most recently used LUT.
+     * The cache is thread_local so there are no locks and no false sharing */
+    static thread_local const CompositeLookupTable<TIN,TOUT>* cached_composite = nullptr;
+    static thread_local std::size_t cached_index = 0;
+    /* the index bound also guards against another (larger) composite having
+     * lived at this address earlier in the thread's lifetime */
+    if(cached_composite == this && cached_index < m_luts.size()){
+      const auto& lut = m_luts[cached_index];
+      if((lut->min_arg() < x) && (x < lut->max_arg())) return (*lut)(x);
     }
-    if((localrecentLUT->min_arg() < x) && (x < localrecentLUT->max_arg())) return (*localrecentLUT)(x);
 
     /* Find the LUT whose right endpoint is strictly greater than x
      * TODO is this problematic for the max arg of the compositeLUT? */
-    auto iter = m_lutmap.upper_bound(x);
-    if(iter != m_lutmap.cend()){
-      auto lut = iter->second;
+    std::size_t k;
+    if(!m_dispatch.empty() && x >= m_dispatchMin && x <= m_breakpoints.back()){
+      /* O(1) dispatch: hash x into the uniform grid, then advance past any
+       * breakpoints the cell straddles (usually zero iterations) */
+      std::size_t cell = static_cast<std::size_t>(m_dispatchStepInv*(x - m_dispatchMin));
+      if(cell >= m_dispatch.size()) cell = m_dispatch.size()-1u;
+      k = m_dispatch[cell];
+      while(k < m_breakpoints.size() && m_breakpoints[k] <= x) ++k;
+    }else{
+      k = static_cast<std::size_t>(
+          std::upper_bound(m_breakpoints.cbegin(), m_breakpoints.cend(), x) - m_breakpoints.cbegin());
+    }
+    if(k < m_luts.size()){
+      const auto& lut = m_luts[k];
       if(lut->min_arg() < x){
-        #pragma omp critical(diedie)
-        {
-          recentLUT = lut;
-        }
+        cached_composite = this;
+        cached_index = k;
         return (*lut)(x);
       }
     }
@@ -113,46 +197,51 @@ public:
   }
 
   std::string name() const final { return "CompositeLookupTable"; }
-  TIN min_arg() const final { return m_lutmap.cbegin()->second->min_arg(); }
-  TIN max_arg() const final { return m_lutmap.crbegin()->first; }
+  TIN min_arg() const final { return m_luts.front()->min_arg(); }
+  TIN max_arg() const final { return m_breakpoints.back(); }
   unsigned int order() const final { return 0u; } // TODO maybe return min order?
 
   /* sum the sizes of each LookupTable */
   std::size_t size() const final {
-    return std::accumulate(m_lutmap.cbegin(), m_lutmap.cend(), std::size_t{0},
-      [](std::size_t total, const typename lookup_map_t::value_type& L)
-      { return total + L.second->size(); });
+    return std::accumulate(m_luts.cbegin(), m_luts.cend(), std::size_t{0},
+      [](std::size_t total, const std::shared_ptr<LookupTable<TIN,TOUT>>& L)
+      { return total + L->size(); });
   }
 
   unsigned int num_subintervals() const final {
-    return std::accumulate(m_lutmap.cbegin(), m_lutmap.cend(), 0u,
-      [](unsigned int total, const typename lookup_map_t::value_type& L)
-      { return total + L.second->num_subintervals(); });
+    return std::accumulate(m_luts.cbegin(), m_luts.cend(), 0u,
+      [](unsigned int total, const std::shared_ptr<LookupTable<TIN,TOUT>>& L)
+      { return total + L->num_subintervals(); });
   }
 
   /* return the min step size of each LookupTable */
   TIN step_size() const final {
-    return std::min_element(m_lutmap.cbegin(), m_lutmap.cend(),
-      [](const typename lookup_map_t::value_type& L1, const typename lookup_map_t::value_type& L2)
-      { return L1.second->step_size() <= L2.second->step_size(); })->second->step_size(); }
+    return (*std::min_element(m_luts.cbegin(), m_luts.cend(),
+      [](const std::shared_ptr<LookupTable<TIN,TOUT>>& L1, const std::shared_ptr<LookupTable<TIN,TOUT>>& L2)
+      { return L1->step_size() < L2->step_size(); }))->step_size(); }
 
   std::pair<TIN,TIN> bounds_of_subinterval(unsigned int intervalNumber) const final {
     long int N = intervalNumber; // need a signed integer to safely do subtraction
-    auto it = m_lutmap.cbegin();
-    for(; it != m_lutmap.cend(); ++it){
-      auto it_nsubs = it->second->num_subintervals();
+    auto it = m_luts.cbegin();
+    for(; it != m_luts.cend(); ++it){
+      auto it_nsubs = (*it)->num_subintervals();
       if(N - it_nsubs < 0)
         break;
       N -= it_nsubs;
     }
-    if(it == m_lutmap.cend())
+    if(it == m_luts.cend())
       throw std::invalid_argument(std::string("Error in func::CompositeLookupTable: requested intervalNumber is ") + std::to_string(N) +
           " which is greater than num_subintervals = " + std::to_string(num_subintervals()));
-    return it->second->bounds_of_subinterval(N);
+    return (*it)->bounds_of_subinterval(N);
   }
 
   void print_json(std::ostream& out) const final { (void) out; /* TODO call to_json() */ };
-  std::shared_ptr<LookupTable<TIN,TOUT>> get_table(TIN x){ return m_lutmap.lower_bound(x)->second; }
+
+  std::shared_ptr<LookupTable<TIN,TOUT>> get_table(TIN x){
+    auto it = std::lower_bound(m_breakpoints.cbegin(), m_breakpoints.cend(), x);
+    std::size_t k = static_cast<std::size_t>(it - m_breakpoints.cbegin());
+    return m_luts[k < m_luts.size() ? k : m_luts.size()-1u];
+  }
 };
 
 } // namespace func
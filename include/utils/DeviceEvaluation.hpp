@@ -0,0 +1,130 @@
+/*
+  An accelerator evaluation engine for MetaTable-derived LUTs, built on
+  OpenMP target offload (the parallel programming model FunC already uses
+  everywhere else, so it needs no new toolchain or language dialect --
+  compile with your compiler's offload flags, eg. -fopenmp plus
+  -foffload=nvptx-none for GCC/CUDA devices, and the same binary still runs
+  on the host when no device exists).
+
+  The engine uploads a flat copy of the table's coefficients to the device
+  once at construction, and eval(xs, out, n) mirrors MetaTable::eval's
+  hash + Horner kernel in a target region, for both uniform and
+  transfer-function (nonuniform) hashes. Because the device copy is made
+  from the generator-built table, regenerating a table and rebuilding the
+  engine can never leave host and device out of sync.
+
+  Usage example:
+
+    UniformChebyInterpTable<3,float> L(fc, par);
+    DeviceEvaluation<decltype(L)> dev(L);
+    dev.eval(xs_dev_or_host, out, n);   // runs on the device when present
+
+  Notes:
+  - offloading() reports whether a device is available; without one the
+    kernel runs as a host omp parallel for.
+  - The engine keeps its own flat coefficient copy so the source table may
+    be destroyed after construction.
+*/
+#pragma once
+#include "LookupTable.hpp"
+#include <vector>
+#include <array>
+#include <cstddef>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace func {
+
+template <class LUT_TYPE>
+class DeviceEvaluation
+{
+public:
+  using input_type = typename LUT_TYPE::input_type;
+  using output_type = typename LUT_TYPE::output_type;
+
+private:
+  using TIN = input_type;
+  using TOUT = output_type;
+  static constexpr unsigned int N = LUT_TYPE::num_coefs;
+
+  std::vector<TOUT> m_coefs;  //!< flat [interval*N + coef] copy living on host and device
+  TIN m_minArg, m_stepSize_inv;
+  std::array<TIN,4> m_tf;     //!< transfer function coefs (all zero for uniform grids)
+  bool m_nonuniform;
+
+public:
+  DeviceEvaluation(const LUT_TYPE& lut) :
+    m_minArg(lut.min_arg()), m_stepSize_inv(static_cast<TIN>(1.0)/lut.step_size()),
+    m_tf(lut.transfer_function_coefs())
+  {
+    m_nonuniform = m_tf[0] != TIN(0) || m_tf[1] != TIN(0) || m_tf[2] != TIN(0) || m_tf[3] != TIN(0);
+    unsigned int entries = lut.num_table_entries();
+    m_coefs.resize(static_cast<std::size_t>(entries)*N);
+    for(unsigned int i=0; i<entries; i++)
+      for(unsigned int j=0; j<N; j++)
+        m_coefs[static_cast<std::size_t>(i)*N + j] = lut.table_entry(i,j);
+
+    TOUT* c = m_coefs.data();
+    std::size_t len = m_coefs.size();
+    #pragma omp target enter data map(to: c[0:len])
+    (void) c; (void) len;
+  }
+
+  ~DeviceEvaluation(){
+    TOUT* c = m_coefs.data();
+    std::size_t len = m_coefs.size();
+    #pragma omp target exit data map(delete: c[0:len])
+    (void) c; (void) len;
+  }
+
+  /* the device copy has no owner besides us */
+  DeviceEvaluation(const DeviceEvaluation&) = delete;
+  DeviceEvaluation& operator=(const DeviceEvaluation&) = delete;
+
+  /** true iff a target device is available (otherwise eval runs on the host) */
+  bool offloading() const {
+#ifdef _OPENMP
+    return omp_get_num_devices() > 0;
+#else
+    return false;
+#endif
+  }
+
+  /** \brief MetaTable::eval's hash + Horner kernel as a device array kernel */
+  void eval(const TIN* xs, TOUT* out, std::size_t n) const
+  {
+    const TOUT* coefs = m_coefs.data();
+    const TIN minArg = m_minArg;
+    const TIN stepSize_inv = m_stepSize_inv;
+    const TIN tf0 = m_tf[0], tf1 = m_tf[1], tf2 = m_tf[2], tf3 = m_tf[3];
+    const bool nonuniform = m_nonuniform;
+
+    #pragma omp target teams distribute parallel for map(to: xs[0:n]) map(from: out[0:n])
+    for(std::size_t i=0; i<n; i++){
+      unsigned int x0; TIN dx;
+      if(!nonuniform){
+        dx = stepSize_inv*(xs[i]-minArg);
+        x0 = static_cast<unsigned int>(dx);
+        dx -= x0;
+      }else{
+        /* the transfer function's cubic inverse, inlined (see
+         * TransferFunction::inverse) */
+        TIN x = xs[i];
+        x0 = static_cast<unsigned int>(x*(tf1 + x*(tf2 + x*tf3)) + tf0);
+        dx = x;
+      }
+
+      const TOUT* c = coefs + static_cast<std::size_t>(x0)*N;
+      TOUT sum = c[N-1];
+      for(unsigned int k=N-1; k>0; k--){
+        sum *= dx;
+        sum += c[k-1];
+      }
+      out[i] = sum;
+    }
+  }
+};
+
+} // namespace func
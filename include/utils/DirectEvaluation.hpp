@@ -25,6 +25,7 @@
 #include "StdRng.hpp"
 
 #include <fstream> // ifstream, ostream
+#include <atomic> // telemetry counters
 
 #ifdef FUNC_DEBUG
   #include "ArgumentRecord.hpp"
@@ -32,10 +33,14 @@
 
 namespace func {
 
-template <typename TIN, typename TOUT = TIN>
+/* F is the stored callable: std::function by default, but a concrete type
+ * (via make_direct_evaluation) removes the type erasure from every call */
+template <typename TIN, typename TOUT = TIN, typename F = std::function<TOUT(TIN)>>
 class DirectEvaluation final : public LookupTable<TIN,TOUT>
 {
-  std::function<TOUT(TIN)> m_func;
+  F m_func;
+  /* always-on telemetry (see EvalStats): one relaxed increment per call */
+  mutable std::atomic<unsigned long long> m_totalEvals{0};
 #ifdef FUNC_DEBUG
   mutable std::unique_ptr<ArgumentRecord<TIN>> mp_recorder;
   mutable StdRng<TIN> m_sampler{0,1}; // uniformly distrubuted random numbers in [0,1]
@@ -50,7 +55,7 @@ public:
       TIN min = 0.0, TIN max = 1.0, unsigned int histSize = 10, TOUT aerr = 0.0, TIN rerr = 0.0, std::ostream* streamer = nullptr) :
     m_func(func_container.standard_fun)
   {
-    if(m_func == nullptr)
+    if(func_container.standard_fun == nullptr)
       throw std::invalid_argument("Error in func::DirectEvaluation: given a FunctionContainer with null function.");
 
     #ifdef FUNC_DEBUG
@@ -62,6 +67,19 @@ public:
     (void) min; (void) max; (void) histSize; (void) rerr; (void) aerr; (void) streamer;
   }
 
+  /* build from a raw callable (see make_direct_evaluation); no null check is
+   * possible or needed for an unerased callable */
+  DirectEvaluation(F f, TIN min, TIN max, unsigned int histSize = 10, TOUT aerr = 0.0, TIN rerr = 0.0, std::ostream* streamer = nullptr) :
+    m_func(f)
+  {
+    #ifdef FUNC_DEBUG
+      mp_recorder = std::unique_ptr<ArgumentRecord<TIN>>(new ArgumentRecord<TIN>(min, max, histSize, streamer));
+      m_rerr = rerr;
+      m_aerr = aerr;
+    #endif
+    (void) min; (void) max; (void) histSize; (void) rerr; (void) aerr; (void) streamer;
+  }
+
   /* rebuild this class and it's arg record from a file */
   //DirectEvaluation(const FunctionContainer<TIN,TOUT>& func_container, std::string filename) :
   //  m_func(func_container.standard_fun)
@@ -77,6 +95,7 @@ public:
   /** \brief Evaluate the underlying std::function and optionally record the argument x */
   TOUT operator()(TIN x) const final
   {
+    m_totalEvals.fetch_add(1, std::memory_order_relaxed);
     #ifdef FUNC_DEBUG
       mp_recorder->record_arg(x);
       return m_aerr*m_sampler.get_point() + m_func(x)*(static_cast<TIN>(1.0) + m_rerr*m_sampler.get_point());
@@ -84,6 +103,30 @@ public:
     return m_func(x);
   }
 
+  /** \brief Capture raw argument sequences for trace-replay benchmarking
+   * (no-ops unless compiled with FUNC_DEBUG; see ArgumentRecord). */
+  void enable_tracing(std::size_t maxSamplesPerThread){
+    #ifdef FUNC_DEBUG
+      mp_recorder->enable_tracing(maxSamplesPerThread);
+    #endif
+    (void) maxSamplesPerThread;
+  }
+  void write_trace(const std::string& filename) const {
+    #ifdef FUNC_DEBUG
+      mp_recorder->write_trace(filename);
+    #else
+      throw std::invalid_argument("Error in func::DirectEvaluation.write_trace: compile with -DFUNC_DEBUG to record traces");
+    #endif
+    (void) filename;
+  }
+
+  /** \brief Always-on counter of how often this function was evaluated */
+  EvalStats stats() const {
+    EvalStats s;
+    s.total_evals = m_totalEvals.load(std::memory_order_relaxed);
+    return s;
+  }
+
   std::string name() const final { return "DirectEvaluation"; }
   TIN min_arg() const final { return -std::numeric_limits<TIN>::infinity(); };
   TIN max_arg() const final { return std::numeric_limits<TIN>::infinity(); };
@@ -94,10 +137,12 @@ public:
   std::pair<TIN,TIN> bounds_of_subinterval(unsigned int intervalNumber) const final { (void) intervalNumber; return std::make_pair(min_arg(),max_arg()); };
 
   void print_json(std::ostream& out) const final {
-    (void) out;
+    nlohmann::json jsonStats;
+    jsonStats["stats"]["total_evals"] = m_totalEvals.load(std::memory_order_relaxed);
     #ifdef FUNC_DEBUG
-    out << mp_recorder->print_json(out);
+    mp_recorder->print_json(jsonStats);
     #endif
+    out << jsonStats.dump(2) << std::endl;
   }
 
   ~DirectEvaluation(){};
@@ -110,5 +155,15 @@ std::ostream& operator<<(std::ostream& out, const DirectEvaluation<TIN,TOUT>& D)
   return out;
 }
 
+/** \brief Build a DirectEvaluation whose callable type is not erased, so the
+ * hot path is an inlinable call instead of a std::function dispatch.
+ *
+ * eg. auto de = func::make_direct_evaluation(func::make_function_container<double>(f), 0.0, 10.0); */
+template <typename F, typename TIN, typename TOUT>
+DirectEvaluation<TIN,TOUT,F> make_direct_evaluation(const StaticFunctionContainer<F,TIN,TOUT>& fc,
+    TIN min = 0.0, TIN max = 1.0, unsigned int histSize = 10, TOUT aerr = 0.0, TIN rerr = 0.0, std::ostream* streamer = nullptr){
+  return DirectEvaluation<TIN,TOUT,F>(fc.raw_fun, min, max, histSize, aerr, rerr, streamer);
+}
+
 // TODO make to_json()
 } // namespace func
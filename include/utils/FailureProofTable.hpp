@@ -27,6 +27,7 @@
 #include "LookupTable.hpp"
 #include "json.hpp"
 #include <memory> // unique_ptr
+#include <atomic> // telemetry counters
 #include <fstream> //ifstream
 #include <limits> // std::numeric_limits<TIN>::max() / lowest()
 #include <boost/math/special_functions/sign.hpp>
@@ -44,6 +45,10 @@ class FailureProofTable final : public LookupTable<typename LUT_TYPE::input_type
 
   LUT_TYPE m_LUT;
   std::function<TIN(TOUT)> m_fun;
+
+  /* always-on telemetry: relaxed atomics so the hot path never serializes */
+  mutable std::atomic<unsigned long long> m_totalEvals{0};
+  mutable std::atomic<unsigned long long> m_oobEvals{0};
   
   #ifdef FUNC_DEBUG
     mutable std::unique_ptr<ArgumentRecord<TIN>> mp_recorder;
@@ -87,6 +92,7 @@ public:
   /* if x isn't in the LUT's bounds, then return f(x) */
   TOUT operator()(TIN x) const final
   {
+    m_totalEvals.fetch_add(1, std::memory_order_relaxed);
     // check if x is in the range of the LUT
     // try boost sign????
     //if(boost::math::sign(x - m_LUT.min_arg()) * boost::math::sign(m_LUT.max_arg() - x) > 0){
@@ -94,6 +100,7 @@ public:
     if((m_LUT.min_arg() < x) && (x < m_LUT.max_arg())){
       return m_LUT(x);
     }else{
+      m_oobEvals.fetch_add(1, std::memory_order_relaxed);
       #ifdef FUNC_DEBUG
         mp_recorder->record_arg(x);
       #endif
@@ -101,6 +108,15 @@ public:
     }
   }
 
+  /** \brief Always-on counters: how hot is this table, and how often does it
+   * fall back to the slow m_fun path? */
+  EvalStats stats() const {
+    EvalStats s;
+    s.total_evals = m_totalEvals.load(std::memory_order_relaxed);
+    s.out_of_domain_evals = m_oobEvals.load(std::memory_order_relaxed);
+    return s;
+  }
+
   std::string name() const final { return std::string("FailureProof") + m_LUT.name(); }
   TIN min_arg() const final { return m_LUT.min_arg(); }
   TIN max_arg() const final { return m_LUT.max_arg();}
@@ -112,10 +128,13 @@ public:
   
   void print_json(std::ostream& out) const final
   { 
-    (void) out; 
+    nlohmann::json jsonStats;
+    jsonStats["stats"]["total_evals"] = m_totalEvals.load(std::memory_order_relaxed);
+    jsonStats["stats"]["out_of_domain_evals"] = m_oobEvals.load(std::memory_order_relaxed);
     #ifdef FUNC_DEBUG
-      out << mp_recorder->print_json(out);
+      mp_recorder->print_json(jsonStats);
     #endif
+    out << jsonStats.dump(2) << std::endl;
   };
 };
 
@@ -18,9 +18,97 @@
 #include <cassert>
 #include <iostream>
 #include <typeinfo> // typeid
+#include <chrono> // per-call latency fallback clock
+#include <fstream> // use_trace
+#include <cstdint> // trace header
+
+#if defined(__linux__)
+#include <linux/perf_event.h> // optional hardware counters
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h> // __rdtsc for cheap per-call latency samples
+#endif
+
+#ifdef _OPENMP
+#include <omp.h> // run_parallel_timings thread ids
+#endif
 
 namespace func {
 
+/* read a timestamp cheap enough to wrap a single table evaluation.
+ * rdtsc ticks on x86, nanoseconds elsewhere (coarser but portable) */
+inline double func_tick(){
+#if defined(__x86_64__) || defined(__i386__)
+  return static_cast<double>(__rdtsc());
+#else
+  return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+#if defined(__linux__)
+/** \brief A perf_event_open counter group (cache misses, branch misses,
+ * instructions) wrapped around a timing pass.
+ *
+ * Silently disables itself when the kernel refuses the syscall (common in
+ * containers and with perf_event_paranoid > 2) so timing still works. */
+class PerfEventSet {
+  int m_fds[3] = {-1,-1,-1};
+
+  static int open_counter(unsigned int config){
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+  }
+
+public:
+  /* owns file descriptors so copying would double-close them */
+  PerfEventSet(const PerfEventSet&) = delete;
+  PerfEventSet& operator=(const PerfEventSet&) = delete;
+
+  PerfEventSet(){
+    m_fds[0] = open_counter(PERF_COUNT_HW_CACHE_MISSES);
+    m_fds[1] = open_counter(PERF_COUNT_HW_BRANCH_MISSES);
+    m_fds[2] = open_counter(PERF_COUNT_HW_INSTRUCTIONS);
+  }
+  ~PerfEventSet(){
+    for(int fd : m_fds)
+      if(fd >= 0) close(fd);
+  }
+  bool ok() const { return m_fds[0] >= 0 && m_fds[1] >= 0 && m_fds[2] >= 0; }
+  void start(){
+    for(int fd : m_fds){
+      if(fd < 0) continue;
+      ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+  /* returns {cache misses, branch misses, instructions} */
+  std::array<long long,3> stop(){
+    std::array<long long,3> vals = {{-1,-1,-1}};
+    for(unsigned int i=0; i<3; i++){
+      if(m_fds[i] < 0) continue;
+      ioctl(m_fds[i], PERF_EVENT_IOC_DISABLE, 0);
+      long long v = 0;
+      if(read(m_fds[i], &v, sizeof(v)) == sizeof(v))
+        vals[i] = v;
+    }
+    return vals;
+  }
+};
+#endif // __linux__
+
 template <typename TIN, typename TOUT>
 using ImplContainer = std::vector<std::unique_ptr<LookupTable<TIN,TOUT>>>;
 
@@ -41,7 +129,20 @@ struct ImplTimer
   std::vector<double> evaluationTimes;
   double maxTime, minTime, meanTime;
 
-  ImplTimer(LookupTable<TIN,TOUT> *inImpl) : impl(inImpl), maxTime(0), minTime(0), meanTime(0) {};
+  /* per-call latency percentiles (rdtsc ticks, or ns off x86; 0 until
+   * run_latency_sampling is called) */
+  double latencyP50, latencyP99, latencyP999;
+  /* hardware counter totals across every counted pass (-1 when unavailable) */
+  long long cacheMisses, branchMisses, instructions;
+  unsigned long long countedEvals; //!< evaluations covered by the counters above
+
+  /* aggregate throughput of concurrent evaluation: pairs of
+   * (thread count, evaluations per second). See run_parallel_timings */
+  std::vector<std::pair<unsigned int,double>> parallelThroughput;
+
+  ImplTimer(LookupTable<TIN,TOUT> *inImpl) : impl(inImpl), maxTime(0), minTime(0), meanTime(0),
+    latencyP50(0), latencyP99(0), latencyP999(0),
+    cacheMisses(-1), branchMisses(-1), instructions(-1), countedEvals(0) {};
 
   void append_runtime(double time){ evaluationTimes.push_back(time); };
   void compute_timing_stats() {
@@ -92,21 +193,44 @@ private:
   //  double minTime, maxTime, meanTime;
   //} m_timingStatistics;
 
-  /* Fill mp_randomEvaluations with random points to be evaluated */
+  bool m_replayTrace = false;
+
+  /* Fill mp_randomEvaluations with random points to be evaluated
+   * (a replayed trace is kept exactly as recorded) */
   void draw_new_sample_points() {
+    if(m_replayTrace) return;
     for (int ii=0;ii<m_nEvals;++ii)
       mp_randomEvaluations[ii] = mp_sampler->get_point();
   }
 
+  bool m_usePerfCounters = false;
+
   /* Time implementation evaluations */
   void run_all_single()
   {
     for (auto &itImplTimer : m_implTimers) {
+#if defined(__linux__)
+      PerfEventSet counters;
+      bool counting = m_usePerfCounters && counters.ok();
+      if(counting) counters.start();
+#endif
       Timer evalTimer;
       for (int ii=0;ii<m_nEvals;++ii)
         m_evalHolder[ii] = (*(itImplTimer.impl))(mp_randomEvaluations[ii]);
 
       evalTimer.stop();
+#if defined(__linux__)
+      if(counting){
+        auto vals = counters.stop();
+        /* first counted pass replaces the -1 sentinels */
+        if(itImplTimer.countedEvals == 0)
+          itImplTimer.cacheMisses = itImplTimer.branchMisses = itImplTimer.instructions = 0;
+        itImplTimer.cacheMisses += vals[0];
+        itImplTimer.branchMisses += vals[1];
+        itImplTimer.instructions += vals[2];
+        itImplTimer.countedEvals += m_nEvals;
+      }
+#endif
       itImplTimer.append_runtime(evalTimer.duration());
     }
   }
@@ -126,6 +250,133 @@ public:
     }
   }
 
+  /** \brief Replay a recorded argument stream instead of sampling uniform
+   * random points.
+   *
+   * Uniform random arguments maximally defeat caches and look nothing like
+   * production access patterns (temporally correlated, sharply nonuniform),
+   * which can rank table sizes wrongly. This loads a binary trace written by
+   * ArgumentRecord::write_trace and times every implementation over exactly
+   * that sequence, in order. nEvals becomes the trace length. */
+  void use_trace(const std::string& filename){
+    std::ifstream in(filename, std::ios::binary);
+    if(!in)
+      throw std::invalid_argument("Error in func::LookupTableComparator.use_trace: cannot open " + filename);
+    char magic[8];
+    in.read(magic, 8);
+    if(in.gcount() != 8 || std::string(magic, 8) != "FunCTRC1")
+      throw std::invalid_argument("Error in func::LookupTableComparator.use_trace: " + filename + " is not a FunC trace file");
+    std::uint64_t elem_size = 0;
+    in.read(reinterpret_cast<char*>(&elem_size), sizeof(elem_size));
+    if(elem_size != sizeof(TIN))
+      throw std::invalid_argument("Error in func::LookupTableComparator.use_trace: " + filename +
+          " was recorded with a different input type (element size " + std::to_string(elem_size) +
+          " vs " + std::to_string(sizeof(TIN)) + ")");
+    std::uint64_t count = 0;
+    in.read(reinterpret_cast<char*>(&count), sizeof(count));
+    if(count == 0 || count > static_cast<std::uint64_t>(std::numeric_limits<int>::max()))
+      throw std::invalid_argument("Error in func::LookupTableComparator.use_trace: " + filename + " holds no usable samples");
+
+    m_nEvals = static_cast<int>(count);
+    mp_randomEvaluations.reset(new TIN[m_nEvals]);
+    in.read(reinterpret_cast<char*>(mp_randomEvaluations.get()), count*sizeof(TIN));
+    if(in.gcount() != static_cast<std::streamsize>(count*sizeof(TIN)))
+      throw std::invalid_argument("Error in func::LookupTableComparator.use_trace: " + filename + " is truncated");
+    m_evalHolder.reset(new TOUT[m_nEvals]);
+    m_replayTrace = true;
+  }
+
+  /** \brief Time implementations under concurrent evaluation from nThreads
+   * OpenMP threads.
+   *
+   * Single-threaded timings rank table sizes very differently from the
+   * deployed configuration where many threads share the last-level cache.
+   * Every thread evaluates the same random sample into a private output
+   * buffer it allocated and warmed itself before the timed window; each
+   * thread times its own pass and the slowest one (they start on a shared
+   * barrier) is the wall clock, so the aggregate throughput (total
+   * evaluations per wall-clock second) is recorded per implementation and
+   * printed by print_summary/print_json. Call with several thread counts to
+   * see the scaling curve. */
+  void run_parallel_timings(unsigned int nThreads, int nRuns = 1)
+  {
+    for(int run=0; run<nRuns; ++run){
+      draw_new_sample_points();
+      for (auto &itImplTimer : m_implTimers) {
+        std::vector<double> threadTimes(nThreads, 0.0);
+        unsigned int teamSize = 1;
+        #pragma omp parallel num_threads(nThreads)
+        {
+          /* allocate and warm the private output buffer (and the table's
+           * cache lines) per thread, before anything is timed: buffer page
+           * faults and team spin-up used to land inside the timed window and
+           * skewed small-nEvals throughput low */
+          std::vector<TOUT> sink(m_nEvals);
+          for (int ii=0;ii<m_nEvals;++ii)
+            sink[ii] = (*(itImplTimer.impl))(mp_randomEvaluations[ii]);
+
+          #pragma omp barrier
+          Timer evalTimer;
+          for (int ii=0;ii<m_nEvals;++ii)
+            sink[ii] = (*(itImplTimer.impl))(mp_randomEvaluations[ii]);
+          evalTimer.stop();
+
+          unsigned int tid = 0;
+#ifdef _OPENMP
+          tid = static_cast<unsigned int>(omp_get_thread_num());
+          #pragma omp single
+          teamSize = static_cast<unsigned int>(omp_get_num_threads());
+#endif
+          if(tid < nThreads)
+            threadTimes[tid] = evalTimer.duration();
+        }
+        /* the barrier starts every thread together, so the slowest thread's
+         * time is the wall clock of the whole pass. The runtime may hand us
+         * fewer threads than requested, so report the actual team size */
+        double wall = *std::max_element(threadTimes.begin(), threadTimes.begin()+teamSize);
+        double total_evals = static_cast<double>(m_nEvals)*teamSize;
+        itImplTimer.parallelThroughput.push_back(std::make_pair(teamSize, total_evals/wall));
+      }
+    }
+  }
+
+  /** \brief Also gather hardware counters (cache misses, branch misses,
+   * instructions) around every subsequent timing pass via perf_event_open.
+   * Linux only; silently a no-op when the kernel refuses the counters. */
+  void enable_perf_counters(){ m_usePerfCounters = true; }
+
+  /** \brief Sample per-call latencies and compute p50/p99/p999 per
+   * implementation.
+   *
+   * The coarse Timer in run_all_single only sees whole-pass durations, which
+   * hides tail behaviour (a table that misses cache on 1% of calls can have a
+   * great mean and a terrible p99). Each call is wrapped in rdtsc reads
+   * (nanoseconds off x86), so individual samples carry ~tens of cycles of
+   * measurement overhead: compare implementations against each other rather
+   * than treating the values as absolute. */
+  void run_latency_sampling(unsigned int nSamples = 10000)
+  {
+    if(nSamples == 0) return;
+    draw_new_sample_points();
+    std::vector<double> lat(nSamples);
+    for (auto &itImplTimer : m_implTimers) {
+      /* warm up the table's cache lines with one pass */
+      for (int ii=0;ii<m_nEvals;++ii)
+        m_evalHolder[ii] = (*(itImplTimer.impl))(mp_randomEvaluations[ii]);
+
+      for (unsigned int s=0;s<nSamples;++s) {
+        TIN x = mp_randomEvaluations[s % m_nEvals];
+        double t0 = func_tick();
+        m_evalHolder[0] = (*(itImplTimer.impl))(x);
+        lat[s] = func_tick() - t0;
+      }
+      std::sort(lat.begin(), lat.end());
+      itImplTimer.latencyP50  = lat[static_cast<std::size_t>(0.50*(nSamples-1))];
+      itImplTimer.latencyP99  = lat[static_cast<std::size_t>(0.99*(nSamples-1))];
+      itImplTimer.latencyP999 = lat[static_cast<std::size_t>(0.999*(nSamples-1))];
+    }
+  }
+
   /* Compute fastest and slowest times */
   void compute_statistics()
   {
@@ -247,6 +498,21 @@ inline void LookupTableComparator<TIN,TOUT>::print_json(std::ostream &out)
     jsonStats[(itImplTimer.impl)->name()]["max"]  = itImplTimer.maxTime;
     jsonStats[(itImplTimer.impl)->name()]["mean"] = itImplTimer.meanTime;
     jsonStats[(itImplTimer.impl)->name()]["raw"]  = itImplTimer.evaluationTimes;
+    if(itImplTimer.latencyP50 > 0){
+      jsonStats[(itImplTimer.impl)->name()]["latency_ticks"]["p50"]  = itImplTimer.latencyP50;
+      jsonStats[(itImplTimer.impl)->name()]["latency_ticks"]["p99"]  = itImplTimer.latencyP99;
+      jsonStats[(itImplTimer.impl)->name()]["latency_ticks"]["p999"] = itImplTimer.latencyP999;
+    }
+    if(!itImplTimer.parallelThroughput.empty()){
+      for(auto& tp : itImplTimer.parallelThroughput)
+        jsonStats[(itImplTimer.impl)->name()]["parallel_evals_per_sec"][std::to_string(tp.first)].push_back(tp.second);
+    }
+    if(itImplTimer.countedEvals > 0){
+      jsonStats[(itImplTimer.impl)->name()]["perf"]["evals"]         = itImplTimer.countedEvals;
+      jsonStats[(itImplTimer.impl)->name()]["perf"]["cache_misses"]  = itImplTimer.cacheMisses;
+      jsonStats[(itImplTimer.impl)->name()]["perf"]["branch_misses"] = itImplTimer.branchMisses;
+      jsonStats[(itImplTimer.impl)->name()]["perf"]["instructions"]  = itImplTimer.instructions;
+    }
   }
   out << jsonStats.dump(2) << std::endl;
 }
@@ -327,6 +593,16 @@ inline void LookupTableComparator<TIN,TOUT>::print_summary(std::ostream &out)
     out << "| LookupTable:      " << (*itImplTimer.impl) << "\n";
     out << "| Memory usage (B): " << (itImplTimer.impl)->size() << "\n";
     out << "| Timings:          "; itImplTimer.print_timing_stats(out);
+    if(itImplTimer.latencyP50 > 0)
+      out << "| Latency (ticks):  p50 " << itImplTimer.latencyP50
+          << " p99 " << itImplTimer.latencyP99
+          << " p999 " << itImplTimer.latencyP999 << "\n";
+    for(auto& tp : itImplTimer.parallelThroughput)
+      out << "| Throughput (T=" << tp.first << "): " << std::scientific << tp.second << " evals/s\n";
+    if(itImplTimer.countedEvals > 0)
+      out << "| Per eval:         " << itImplTimer.cacheMisses/static_cast<double>(itImplTimer.countedEvals) << " cache misses, "
+          << itImplTimer.branchMisses/static_cast<double>(itImplTimer.countedEvals) << " branch misses, "
+          << itImplTimer.instructions/static_cast<double>(itImplTimer.countedEvals) << " instructions\n";
   }
   out << "----------------------------------------------------------------------------" << std::endl;
 }
@@ -83,8 +83,31 @@ private:
  * -------------------------------------------------------------------------- */ /* *  Initialize the registry
  *  - New implementations of table types must be added to the registry here
  */
+/* The full registry instantiates every table type at every supported degree
+ * for each (TIN,TOUT) pair -- a large chunk of compile time and binary size
+ * even when a build only ever uses one or two table types. To opt in to a
+ * subset, define FUNC_REGISTRY_SELECT plus FUNC_REGISTRY_INCLUDE_<FAMILY>
+ * for each family you need, where <FAMILY> is one of
+ *   TAYLOR, CUBIC_HERMITE, PADE, CHEBY, EXACT_INTERP, LINEAR_RAW.
+ * eg. -DFUNC_REGISTRY_SELECT -DFUNC_REGISTRY_INCLUDE_EXACT_INTERP registers
+ * (and therefore instantiates) only the ExactInterpTables. Without
+ * FUNC_REGISTRY_SELECT everything is registered, as always. The generated
+ * extern-template sources (cmake/src_template.cpp.cmake) compile this same
+ * header, so passing the macros in CMAKE_CXX_FLAGS shrinks libfunc too.
+ * Like FUNC_DEBUG, these must be set uniformly for the whole build: mixing
+ * them across translation units is an ODR violation. */
+#ifndef FUNC_REGISTRY_SELECT
+#define FUNC_REGISTRY_INCLUDE_TAYLOR
+#define FUNC_REGISTRY_INCLUDE_CUBIC_HERMITE
+#define FUNC_REGISTRY_INCLUDE_PADE
+#define FUNC_REGISTRY_INCLUDE_CHEBY
+#define FUNC_REGISTRY_INCLUDE_EXACT_INTERP
+#define FUNC_REGISTRY_INCLUDE_LINEAR_RAW
+#endif
+
 template <typename TIN, typename TOUT>
 void LookupTableFactory<TIN, TOUT>::initialize_registry() {
+#ifdef FUNC_REGISTRY_INCLUDE_TAYLOR
   FUNC_ADD_TABLE_TO_REGISTRY(UniformTaylorTable,1);
   FUNC_ADD_TABLE_TO_REGISTRY(UniformTaylorTable,2);
   FUNC_ADD_TABLE_TO_REGISTRY(UniformTaylorTable,3);
@@ -92,8 +115,12 @@ void LookupTableFactory<TIN, TOUT>::initialize_registry() {
   FUNC_ADD_TABLE_TO_REGISTRY(UniformTaylorTable,5);
   FUNC_ADD_TABLE_TO_REGISTRY(UniformTaylorTable,6);
   FUNC_ADD_TABLE_TO_REGISTRY(UniformTaylorTable,7);
+#endif
+#ifdef FUNC_REGISTRY_INCLUDE_CUBIC_HERMITE
   FUNC_ADD_TABLE_TO_REGISTRY(UniformCubicHermiteTable);
+#endif
 
+#ifdef FUNC_REGISTRY_INCLUDE_TAYLOR
   FUNC_ADD_TABLE_TO_REGISTRY(NonUniformTaylorTable,1);
   FUNC_ADD_TABLE_TO_REGISTRY(NonUniformTaylorTable,2);
   FUNC_ADD_TABLE_TO_REGISTRY(NonUniformTaylorTable,3);
@@ -101,8 +128,12 @@ void LookupTableFactory<TIN, TOUT>::initialize_registry() {
   FUNC_ADD_TABLE_TO_REGISTRY(NonUniformTaylorTable,5);
   FUNC_ADD_TABLE_TO_REGISTRY(NonUniformTaylorTable,6);
   FUNC_ADD_TABLE_TO_REGISTRY(NonUniformTaylorTable,7);
+#endif
+#ifdef FUNC_REGISTRY_INCLUDE_CUBIC_HERMITE
   FUNC_ADD_TABLE_TO_REGISTRY(NonUniformCubicHermiteTable);
+#endif
 
+#ifdef FUNC_REGISTRY_INCLUDE_PADE
   FUNC_ADD_TABLE_TO_REGISTRY(UniformPadeTable,1,1);
   FUNC_ADD_TABLE_TO_REGISTRY(UniformPadeTable,2,1);
   FUNC_ADD_TABLE_TO_REGISTRY(UniformPadeTable,3,1);
@@ -115,7 +146,9 @@ void LookupTableFactory<TIN, TOUT>::initialize_registry() {
   FUNC_ADD_TABLE_TO_REGISTRY(UniformPadeTable,5,2);
   FUNC_ADD_TABLE_TO_REGISTRY(UniformPadeTable,3,3);
   FUNC_ADD_TABLE_TO_REGISTRY(UniformPadeTable,4,3);
+#endif
 
+#ifdef FUNC_REGISTRY_INCLUDE_CHEBY
   FUNC_ADD_TABLE_TO_REGISTRY(UniformChebyInterpTable,1);
   FUNC_ADD_TABLE_TO_REGISTRY(UniformChebyInterpTable,2);
   FUNC_ADD_TABLE_TO_REGISTRY(UniformChebyInterpTable,3);
@@ -131,7 +164,9 @@ void LookupTableFactory<TIN, TOUT>::initialize_registry() {
   FUNC_ADD_TABLE_TO_REGISTRY(NonUniformChebyInterpTable,5);
   FUNC_ADD_TABLE_TO_REGISTRY(NonUniformChebyInterpTable,6);
   FUNC_ADD_TABLE_TO_REGISTRY(NonUniformChebyInterpTable,7);
+#endif
 
+#ifdef FUNC_REGISTRY_INCLUDE_EXACT_INTERP
   FUNC_ADD_TABLE_TO_REGISTRY(UniformExactInterpTable,0);
   FUNC_ADD_TABLE_TO_REGISTRY(UniformExactInterpTable,1);
   FUNC_ADD_TABLE_TO_REGISTRY(UniformExactInterpTable,2);
@@ -139,16 +174,20 @@ void LookupTableFactory<TIN, TOUT>::initialize_registry() {
   FUNC_ADD_TABLE_TO_REGISTRY(UniformExactInterpTable,4);
   FUNC_ADD_TABLE_TO_REGISTRY(UniformExactInterpTable,5);
   FUNC_ADD_TABLE_TO_REGISTRY(UniformExactInterpTable,6);
+#endif
 
+#ifdef FUNC_REGISTRY_INCLUDE_LINEAR_RAW
   FUNC_ADD_TABLE_TO_REGISTRY(UniformLinearRawInterpTable);
+#endif
 
+#ifdef FUNC_REGISTRY_INCLUDE_EXACT_INTERP
   FUNC_ADD_TABLE_TO_REGISTRY(NonUniformExactInterpTable,1);
   FUNC_ADD_TABLE_TO_REGISTRY(NonUniformExactInterpTable,2);
   FUNC_ADD_TABLE_TO_REGISTRY(NonUniformExactInterpTable,3);
   FUNC_ADD_TABLE_TO_REGISTRY(NonUniformExactInterpTable,4);
   FUNC_ADD_TABLE_TO_REGISTRY(NonUniformExactInterpTable,5);
   FUNC_ADD_TABLE_TO_REGISTRY(NonUniformExactInterpTable,6);
-
+#endif
 }
 
 /*
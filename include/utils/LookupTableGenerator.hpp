@@ -1,6 +1,7 @@
 #pragma once
 #include "LookupTable.hpp"
 #include "LookupTableFactory.hpp"
+#include "LookupTableComparator.hpp" // generate_fastest benchmarks its candidates
 #include "config.hpp" // FUNC_USE_BOOST
 
 #include <string>
@@ -9,6 +10,14 @@
 #include <stdexcept>
 #include <cmath> // std::abs, std::min
 #include <typeinfo> // typeid
+#include <fstream> // read/write json & binary LUT files
+#include <sstream> // rebuild json from print_json
+#include <vector> // to_cbor/to_msgpack bytes
+#include <cstdint> // uint8_t
+#include <iterator> // istreambuf_iterator
+#include <numeric> // iota (sampled error estimation)
+#include <algorithm> // partial_sort
+#include <map> // sample cache
 
 
 #ifdef FUNC_USE_BOOST
@@ -132,9 +141,29 @@ private:
     return static_cast<bool>(std::ifstream(filename));
   }
 
+  /* check if filename ends with ext */
+  static bool has_extension(const std::string& filename, const std::string& ext){
+    return filename.size() >= ext.size() && filename.compare(filename.size()-ext.size(), ext.size(), ext) == 0;
+  }
+
   inline void save_lut(LookupTable<TIN,TOUT>* lut, std::string filename){
     if(filename == "") return;
 
+    if(has_extension(filename, ".cbor") || has_extension(filename, ".msgpack")){
+      /* compact binary formats: much faster to read than text json for large
+       * tables. The LookupTable interface only exposes print_json so we
+       * rebuild the json object from its text output (construction-time only) */
+      std::ostringstream ss;
+      lut->print_json(ss);
+      nlohmann::json jsonStats = nlohmann::json::parse(ss.str());
+      std::vector<std::uint8_t> bytes = has_extension(filename, ".cbor") ?
+        nlohmann::json::to_cbor(jsonStats) : nlohmann::json::to_msgpack(jsonStats);
+      std::ofstream out_file(filename, std::ios::binary);
+      out_file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+      out_file.close();
+      return;
+    }
+
     std::ofstream out_file(filename);
     lut->print_json(out_file);
     out_file.close();
@@ -154,12 +183,19 @@ public:
    * tableKey arg only exists as a sanity check (it's pointless otherwise) */
   std::unique_ptr<LookupTable<TIN,TOUT>> generate_by_file(std::string filename, std::string tableKey = "")
   {
-    if(filename.find(".json") == std::string::npos) // TODO are there any other json filename extensions?
-      throw std::invalid_argument("Error in func::LookupTableGenerator.generate_by_file: filename is not a valid json file.");
-
     nlohmann::json jsonStats;
-    std::ifstream ifs(filename); ifs >> jsonStats; ifs.close();
-    
+    if(has_extension(filename, ".cbor") || has_extension(filename, ".msgpack")){
+      std::ifstream ifs(filename, std::ios::binary);
+      std::vector<std::uint8_t> bytes{std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>()};
+      ifs.close();
+      jsonStats = has_extension(filename, ".cbor") ?
+        nlohmann::json::from_cbor(bytes) : nlohmann::json::from_msgpack(bytes);
+    }else if(filename.find(".json") != std::string::npos){ // TODO are there any other json filename extensions?
+      std::ifstream ifs(filename); ifs >> jsonStats; ifs.close();
+    }else{
+      throw std::invalid_argument("Error in func::LookupTableGenerator.generate_by_file: filename is not a valid json/cbor/msgpack file.");
+    }
+
     // get the tableKey from filename
     if(tableKey == ""){
       tableKey = jsonStats["name"].get<std::string>();
@@ -192,6 +228,69 @@ public:
   /* Generate a table takes up desiredSize bytes */
   std::unique_ptr<LookupTable<TIN,TOUT>> generate_by_impl_size(std::string tableKey, unsigned long desiredSize, std::string filename = "");
 
+  /** \brief Return the fastest table on this machine that meets the given
+   * tolerance budget.
+   *
+   * Every candidate (the whole registry by default -- pass a shortlist to
+   * keep the search cheap) is sized with generate_by_tol, the survivors are
+   * benchmarked with LookupTableComparator on this machine, and the winner
+   * is rebuilt and returned. Candidates that cannot be generated here (eg.
+   * Chebyshev without Armadillo) are skipped. When decision_filename is
+   * given the winning (tableKey, stepSize) pair is persisted as json and
+   * later runs load the decision instead of repeating the search -- delete
+   * the file to re-tune, eg. on a new microarchitecture. */
+  std::unique_ptr<LookupTable<TIN,TOUT>> generate_fastest(TIN a_tol, TIN r_tol,
+      std::vector<std::string> candidates = {}, std::string decision_filename = "",
+      unsigned int nEvals = 100000, int nRuns = 5)
+  {
+#ifndef FUNC_USE_BOOST
+    static_assert(sizeof(TIN)!=sizeof(TIN), "Cannot search for the fastest LUT without Boost");
+    return nullptr;
+#else
+    if(decision_filename != "" && file_exists(decision_filename)){
+      nlohmann::json decision;
+      std::ifstream ifs(decision_filename); ifs >> decision;
+      return generate_by_step(decision.at("tableKey").get<std::string>(), decision.at("stepSize").get<TIN>());
+    }
+
+    if(candidates.empty())
+      candidates = factory.get_registered_keys();
+
+    ImplContainer<TIN,TOUT> impls;
+    std::vector<std::pair<std::string,TIN>> built; // (key, winning step) parallel to impls
+    for(auto& key : candidates){
+      try{
+        auto lut = generate_by_tol(key, a_tol, r_tol);
+        built.push_back(std::make_pair(key, lut->step_size()));
+        impls.push_back(std::move(lut));
+      }catch(std::exception&){
+        /* candidate not generatable here (missing dependency, unpredictable
+         * error behaviour, ...): it simply doesn't compete */
+      }
+    }
+    if(impls.empty())
+      throw std::invalid_argument("Error in func::LookupTableGenerator.generate_fastest: no candidate table could be generated");
+
+    LookupTableComparator<TIN,TOUT> comparator(impls, m_min, m_max, nEvals);
+    comparator.run_timings(nRuns);
+    comparator.compute_statistics();
+    std::vector<double> times = comparator.fastest_times(); // best-case times, in candidate order
+    std::size_t winner = static_cast<std::size_t>(
+        std::min_element(times.begin(), times.end()) - times.begin());
+
+    if(decision_filename != ""){
+      nlohmann::json decision;
+      decision["_comment"] = "winning table from func::LookupTableGenerator::generate_fastest";
+      decision["tableKey"] = built[winner].first;
+      decision["stepSize"] = built[winner].second;
+      std::ofstream(decision_filename) << decision.dump(2) << std::endl;
+    }
+    /* the comparator owns the candidates, so rebuild the winner (cheap: one
+     * table construction at a known step) */
+    return generate_by_step(built[winner].first, built[winner].second);
+#endif
+  }
+
   /* Return the approx error in tableKey at stepSize
    * - relTol is a parameter which determines how much effect small f(x) values have on the error calculation */
   long double error_at_step_size(std::string tableKey, TIN stepSize, TIN relTol = static_cast<TIN>(1.0));
@@ -202,6 +301,70 @@ public:
 
   TIN min_arg(){ return m_par.minArg; }
   TIN max_arg(){ return m_par.maxArg; }
+
+  /** \brief Memoize calls to the user's function across table rebuilds.
+   *
+   * Every iterate of generate_by_tol's bisection constructs a complete fresh
+   * LUT, re-evaluating f at every node even though successive step sizes
+   * revisit many of the same arguments (and error estimation samples f at
+   * the same points again). When f costs more than a map lookup (eg. an
+   * ODE-embedded function) caching exact-hit arguments removes most of that
+   * redundant work. Only exact TIN matches hit, only standard_fun is cached
+   * (autodiff samples carry derivative state), and the cache lives for the
+   * generator's lifetime. Thread safe: construction loops are FUNC_BUILDPAR
+   * parallel. */
+  void enable_sample_cache(){
+    if(m_sampleCache) return;
+    m_sampleCache = std::make_shared<std::map<TIN,TOUT>>();
+    auto cache = m_sampleCache;
+    std::function<TOUT(TIN)> fun = m_fc.standard_fun;
+    m_fc.standard_fun = [cache,fun](TIN x) -> TOUT {
+      bool found = false;
+      TOUT y = TOUT();
+      #pragma omp critical(func_generator_sample_cache)
+      {
+        auto it = cache->find(x);
+        if(it != cache->end()){
+          y = it->second;
+          found = true;
+        }
+      }
+      if(!found){
+        y = fun(x);
+        #pragma omp critical(func_generator_sample_cache)
+        {
+          (*cache)[x] = y;
+        }
+      }
+      return y;
+    };
+  }
+
+  /** number of distinct arguments memoized so far (0 if the cache is off) */
+  std::size_t sample_cache_size() const { return m_sampleCache ? m_sampleCache->size() : 0u; }
+
+  /** \brief Switch error estimation to a cheaper two-phase mode.
+   *
+   * By default every subinterval is minimized with Boost's
+   * brent_find_minima in TERR (quad) precision, which dominates
+   * generate_by_tol's runtime for large tables. In two-phase mode each
+   * subinterval is first scanned with nSamples double precision samples and
+   * only the nPolish worst intervals are polished with brent in TERR. The
+   * estimate can miss the true max error when the sampling is too coarse, so
+   * the default behaviour is unchanged; pass nSamples=0 to switch back. */
+  void set_sampled_error_estimation(unsigned int nSamples, unsigned int nPolish = 8u){
+    m_errSamplesPerInterval = nSamples;
+    /* at least one interval must be polished or the estimate is always 0 */
+    m_errPolishCount = nPolish > 0u ? nPolish : 1u;
+  }
+
+private:
+  /* two-phase error estimation parameters (0 = always use brent, the default) */
+  unsigned int m_errSamplesPerInterval = 0;
+  unsigned int m_errPolishCount = 8;
+
+  /* memoized f samples shared with the wrapped standard_fun (see enable_sample_cache) */
+  std::shared_ptr<std::map<TIN,TOUT>> m_sampleCache;
 };
 
 /*----------------------------------------------------------------------------*/
@@ -251,13 +414,68 @@ struct LookupTableGenerator<TIN,TOUT,TERR>::OptimalStepSizeFunctor
     return error_of_table(impl.get());
   }
 
-  TIN error_of_table(const LookupTable<TIN,TOUT>* impl){
+  /* brent_find_minima over one subinterval; returns the (negated) max error found */
+  TERR brent_err_in_interval(const LookupTable<TIN,TOUT>* impl, unsigned int ii){
     using namespace boost::math::tools;
-
     /* get number of binary bits in mantissa */
     int bits = std::numeric_limits<TERR>::digits/2; // effective maximum for brent_find_minima
     boost::uintmax_t max_it = 20;
+
+    std::pair<TIN,TIN> intEndPoints = impl->bounds_of_subinterval(ii);
+    /* TODO
+     * - does float_next and float_prior restrict the possible values of TIN?
+     *   I think they might be the result of an old misdiagnosis
+     * - Is it possible for x or xtop to be rounded outside the LUT's domain after casting to TERR? */
+    TERR x = static_cast<TERR>(boost::math::float_next(intEndPoints.first));
+    TERR xtop = static_cast<TERR>(boost::math::float_prior(intEndPoints.second));
+
+    std::pair<TERR, TERR> r = brent_find_minima(LookupTableErrorFunctor(impl,m_parent.m_fc.standard_fun,m_relTol),x,xtop,bits,max_it);
+    return r.second;
+  }
+
+  TIN error_of_table(const LookupTable<TIN,TOUT>* impl){
     TERR max_err = 0;
+    const unsigned int nsub = impl->num_subintervals();
+
+    if(m_parent.m_errSamplesPerInterval > 0u){
+      /* Two-phase estimate (see set_sampled_error_estimation): scan every
+       * subinterval with cheap double precision samples, then polish only the
+       * worst few with brent in TERR */
+      const unsigned int ns = m_parent.m_errSamplesPerInterval;
+      std::vector<double> sampled_errs(nsub, 0.0);
+      std::function<TOUT(TIN)> fun = m_parent.m_fc.standard_fun;
+      const double relTol = static_cast<double>(m_relTol);
+      #pragma omp parallel for
+      for(unsigned ii=0; ii<nsub; ii++){
+        std::pair<TIN,TIN> b = impl->bounds_of_subinterval(ii);
+        double e = 0.0;
+        for(unsigned int s=0; s<ns; s++){
+          TIN x = b.first + (b.second-b.first)*static_cast<TIN>(s+0.5)/static_cast<TIN>(ns);
+          double f_value = static_cast<double>(fun(x));
+          double lut_value = static_cast<double>((*impl)(x));
+          e = std::max(e, std::abs(f_value-lut_value)/(1.0 + relTol*std::abs(f_value)));
+        }
+        sampled_errs[ii] = e;
+      }
+
+      const unsigned int npolish = std::min(m_parent.m_errPolishCount, nsub);
+      std::vector<unsigned int> idx(nsub);
+      std::iota(idx.begin(), idx.end(), 0u);
+      std::partial_sort(idx.begin(), idx.begin()+npolish, idx.end(),
+          [&sampled_errs](unsigned int a, unsigned int b){ return sampled_errs[a] > sampled_errs[b]; });
+
+      #pragma omp parallel for
+      for(unsigned k=0; k<npolish; k++){
+        TERR e = brent_err_in_interval(impl, idx[k]);
+        #pragma omp critical(FUNC_LUT_GENERATOR_MUTEX)
+        {
+          max_err = std::min(max_err, e);
+        }
+      }
+
+      max_err = -max_err;
+      return static_cast<TIN>(max_err-m_desiredErr);
+    }
 
     /* Want a small bracket for brent's method so for each interval in the table,
      * compute the maximum error.
@@ -268,21 +486,12 @@ struct LookupTableGenerator<TIN,TOUT,TERR>::OptimalStepSizeFunctor
      * - TODO can be slow for high order tables with very few subintervals
      *   */
     #pragma omp parallel for
-    for(unsigned ii=0; ii<impl->num_subintervals(); ii++){
-      std::pair<TIN,TIN> intEndPoints = impl->bounds_of_subinterval(ii);
-      /* TODO 
-       * - does float_next and float_prior restrict the possible values of TIN?
-       *   I think they might be the result of an old misdiagnosis
-       * - Is it possible for x or xtop to be rounded outside the LUT's domain after casting to TERR? */
-      TERR x = static_cast<TERR>(boost::math::float_next(intEndPoints.first));
-      TERR xtop = static_cast<TERR>(boost::math::float_prior(intEndPoints.second));
-
-      std::pair<TERR, TERR> r = brent_find_minima(LookupTableErrorFunctor(impl,m_parent.m_fc.standard_fun,m_relTol),x,xtop,bits,max_it);
-
+    for(unsigned ii=0; ii<nsub; ii++){
+      TERR e = brent_err_in_interval(impl, ii);
       #pragma omp critical(FUNC_LUT_GENERATOR_MUTEX)
       {
-        max_err = std::min(max_err, r.second);
-        //std::cerr << -r.second << " error at x=" << r.first << "\n";
+        max_err = std::min(max_err, e);
+        //std::cerr << -e << " error at x=" << x << "\n";
       }
     }
 
@@ -0,0 +1,138 @@
+/*
+  Replicate a read-only LookupTable onto every NUMA node and route each
+  calling thread to its local replica.
+
+  A single heap-allocated coefficient array lands on one NUMA node, so on a
+  multi-socket machine remote threads pay ~2x latency on every table miss.
+  Read-only LUTs are perfect replication candidates: NumaReplicatedTable
+  deep-copies the wrapped table once per node (using the first-touch policy
+  for placement: each copy is made by a thread already running on the target
+  node, so the copied pages are allocated locally) and operator() picks the
+  calling thread's local replica.
+
+  Usage example:
+
+    UniformChebyInterpTable<3,double> L(fc, par);
+    NumaReplicatedTable<decltype(L)> R(L);
+    double val = R(0.87354);  // reads the replica local to this thread
+
+  Notes:
+  - Implemented without libnuma: the node topology is read from
+    /sys/devices/system/node and threads locate themselves with
+    sched_getcpu. Off Linux (or on single-node machines) this degrades to
+    one replica and behaves like the plain table.
+  - The thread->replica decision is cached thread_local; threads that
+    migrate across nodes mid-run keep reading their original (still correct,
+    merely remote) replica until they next start evaluating a different
+    NumaReplicatedTable instance.
+  - Memory cost is one full table per node.
+*/
+#pragma once
+#include "LookupTable.hpp"
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#if defined(__linux__)
+#include <sched.h> // sched_getcpu
+#endif
+
+namespace func {
+
+template <class LUT_TYPE>
+class NumaReplicatedTable final : public LookupTable<typename LUT_TYPE::input_type, typename LUT_TYPE::output_type>
+{
+  using TIN = typename LUT_TYPE::input_type;
+  using TOUT = typename LUT_TYPE::output_type;
+
+  std::vector<std::unique_ptr<LUT_TYPE>> m_replicas; //!< one per NUMA node
+  std::vector<unsigned int> m_cpu_to_node;           //!< index: cpu id, value: node id
+
+  /* parse /sys/devices/system/node/node<k>/cpulist ("0-3,8-11") into
+   * m_cpu_to_node. Returns the number of nodes found (0 off Linux) */
+  unsigned int read_topology(){
+#if defined(__linux__)
+    unsigned int nodes = 0;
+    for(;; nodes++){
+      std::ifstream cpulist("/sys/devices/system/node/node" + std::to_string(nodes) + "/cpulist");
+      if(!cpulist) break;
+      std::string ranges;
+      std::getline(cpulist, ranges);
+      std::istringstream ss(ranges);
+      std::string range;
+      while(std::getline(ss, range, ',')){
+        std::size_t dash = range.find('-');
+        unsigned long lo = std::stoul(range);
+        unsigned long hi = dash == std::string::npos ? lo : std::stoul(range.substr(dash+1));
+        if(hi >= m_cpu_to_node.size()) m_cpu_to_node.resize(hi+1, 0u);
+        for(unsigned long c=lo; c<=hi; c++) m_cpu_to_node[c] = nodes;
+      }
+    }
+    return nodes;
+#else
+    return 0;
+#endif
+  }
+
+  /* the node this thread is currently running on */
+  unsigned int my_node() const {
+#if defined(__linux__)
+    int cpu = sched_getcpu();
+    if(cpu >= 0 && static_cast<std::size_t>(cpu) < m_cpu_to_node.size())
+      return m_cpu_to_node[cpu];
+#endif
+    return 0u;
+  }
+
+public:
+  /** \brief Deep copy lut onto every NUMA node (or nReplicas nodes when nonzero) */
+  NumaReplicatedTable(const LUT_TYPE& lut, unsigned int nReplicas = 0u){
+    unsigned int nnodes = read_topology();
+    if(nReplicas != 0u) nnodes = nReplicas;
+    if(nnodes == 0u) nnodes = 1u;
+    m_replicas.resize(nnodes);
+
+    /* first-touch placement: let a thread already running on node k make
+     * node k's copy, so its pages are allocated locally */
+    #pragma omp parallel
+    {
+      unsigned int node = my_node();
+      if(node < nnodes){
+        #pragma omp critical(func_numa_replicate)
+        if(!m_replicas[node])
+          m_replicas[node].reset(new LUT_TYPE(lut));
+      }
+    }
+    /* nodes that had no thread in the pool still need a (remote) copy */
+    for(auto& r : m_replicas)
+      if(!r) r.reset(new LUT_TYPE(lut));
+  }
+
+  TOUT operator()(TIN x) const final {
+    /* locating ourselves costs a vDSO call, so cache the replica per thread
+     * (keyed by object so several replicated tables coexist) */
+    static thread_local const NumaReplicatedTable<LUT_TYPE>* cached_table = nullptr;
+    static thread_local unsigned int cached_node = 0;
+    if(cached_table != this || cached_node >= m_replicas.size()){
+      cached_table = this;
+      cached_node = my_node() % m_replicas.size();
+    }
+    return (*m_replicas[cached_node])(x);
+  }
+
+  unsigned int num_replicas() const { return static_cast<unsigned int>(m_replicas.size()); }
+
+  std::string name() const final { return std::string("NumaReplicated<") + m_replicas[0]->name() + ">"; }
+  TIN min_arg() const final { return m_replicas[0]->min_arg(); }
+  TIN max_arg() const final { return m_replicas[0]->max_arg(); }
+  unsigned int order() const final { return m_replicas[0]->order(); }
+  std::size_t size() const final { return m_replicas.size()*m_replicas[0]->size(); }
+  unsigned int num_subintervals() const final { return m_replicas[0]->num_subintervals(); }
+  TIN step_size() const final { return m_replicas[0]->step_size(); }
+  std::pair<TIN,TIN> bounds_of_subinterval(unsigned int intervalNumber) const final { return m_replicas[0]->bounds_of_subinterval(intervalNumber); }
+  void print_json(std::ostream& out) const final { m_replicas[0]->print_json(out); }
+};
+
+} // namespace func
@@ -0,0 +1,94 @@
+/*
+  A string-configurable LookupTable whose concrete type is resolved once, not
+  per call. LookupTableFactory returns unique_ptr<LookupTable> so every
+  evaluation pays a virtual call that blocks inlining of the ~10 instruction
+  Horner body. StaticDispatchTable stores one of a user-chosen list of
+  concrete table types in a std::variant instead: operator() is a std::visit
+  (a jump table, still inlinable), and the batch eval() resolves the
+  alternative once per array instead of once per evaluation.
+
+  Usage example:
+
+    StaticDispatchTable<UniformExactInterpTable<3,double>,
+                        UniformTaylorTable<3,double>>
+      T(func_container, "UniformExactInterpTable<3>", {0,10,0.0001});
+    double val = T(0.87354);           // no vtable hop
+    T.eval(xs, out, n);                // type resolved once for the whole batch
+
+  Notes:
+  - The candidate list is a template parameter because instantiating every
+    registered table type would defeat the purpose (see LookupTableFactory).
+  - To match the given string key against a candidate type we must construct
+    a throwaway single-interval instance of each candidate until one's name()
+    matches (table names are only assigned during construction). This costs a
+    few function samples per candidate at construction time only.
+  - Requires C++17 for std::variant (like everything in cxx17utils.hpp).
+*/
+#pragma once
+#include "config.hpp" // FUNC_NO_CXX17
+#ifndef FUNC_NO_CXX17
+#include "LookupTable.hpp"
+#include <variant>
+#include <string>
+#include <tuple>
+#include <stdexcept>
+
+namespace func {
+
+template <typename... LUT_TYPES>
+class StaticDispatchTable final :
+  public LookupTable<typename std::tuple_element<0,std::tuple<LUT_TYPES...>>::type::input_type,
+                     typename std::tuple_element<0,std::tuple<LUT_TYPES...>>::type::output_type>
+{
+  using first_lut = typename std::tuple_element<0,std::tuple<LUT_TYPES...>>::type;
+  using TIN  = typename first_lut::input_type;
+  using TOUT = typename first_lut::output_type;
+
+  std::variant<LUT_TYPES...> m_table;
+
+  /* build a cheap single-interval probe of LUT to learn its name. If it
+   * matches tableKey then build the real table into m_table */
+  template <typename LUT>
+  bool try_build(const FunctionContainer<TIN,TOUT>& fc, const std::string& tableKey, const LookupTableParameters<TIN>& par){
+    LUT probe(fc, LookupTableParameters<TIN>{par.minArg, par.maxArg, par.maxArg - par.minArg});
+    if(probe.name() != tableKey)
+      return false;
+    m_table = LUT(fc, par);
+    return true;
+  }
+
+public:
+  StaticDispatchTable(const FunctionContainer<TIN,TOUT>& fc, const std::string& tableKey, const LookupTableParameters<TIN>& par){
+    bool found = (try_build<LUT_TYPES>(fc, tableKey, par) || ...);
+    if(!found)
+      throw std::invalid_argument("Error in func::StaticDispatchTable: \"" + tableKey +
+          "\" does not name any of this table's candidate types");
+  }
+
+  TOUT operator()(TIN x) const final {
+    return std::visit([x](const auto& lut){ return lut(x); }, m_table);
+  }
+
+  /* the whole point: resolve the concrete type once per batch, then run its
+   * (inlinable, vectorized) kernel over the array */
+  void eval(const TIN* xs, TOUT* out, std::size_t n) const final {
+    std::visit([xs,out,n](const auto& lut){ lut.eval(xs, out, n); }, m_table);
+  }
+
+  std::string name() const final { return std::visit([](const auto& lut){ return lut.name(); }, m_table); }
+  TIN min_arg() const final { return std::visit([](const auto& lut){ return lut.min_arg(); }, m_table); }
+  TIN max_arg() const final { return std::visit([](const auto& lut){ return lut.max_arg(); }, m_table); }
+  unsigned int order() const final { return std::visit([](const auto& lut){ return lut.order(); }, m_table); }
+  std::size_t size() const final { return std::visit([](const auto& lut){ return lut.size(); }, m_table); }
+  unsigned int num_subintervals() const final { return std::visit([](const auto& lut){ return lut.num_subintervals(); }, m_table); }
+  TIN step_size() const final { return std::visit([](const auto& lut){ return lut.step_size(); }, m_table); }
+  std::pair<TIN,TIN> bounds_of_subinterval(unsigned int intervalNumber) const final {
+    return std::visit([intervalNumber](const auto& lut){ return lut.bounds_of_subinterval(intervalNumber); }, m_table);
+  }
+  void print_json(std::ostream& out) const final {
+    std::visit([&out](const auto& lut){ lut.print_json(out); }, m_table);
+  }
+};
+
+} // namespace func
+#endif // FUNC_NO_CXX17
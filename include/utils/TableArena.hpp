@@ -0,0 +1,128 @@
+/*
+  A bump allocator that packs table coefficient arrays contiguously.
+
+  Tables built through LookupTableFactory land wherever the global allocator
+  puts them, so a collection of hundreds of small LUTs scatters across the
+  heap and evaluating related tables ping-pongs the TLB. While a
+  TableArena::Scope is alive, every MetaTable allocation (factory,
+  CompositeLookupTable, ndimLUT -- anything that ends in allocate_table)
+  draws from the arena's large mmap'ed blocks instead, co-locating tables
+  that are built (and usually evaluated) together. Blocks are advised
+  MADV_HUGEPAGE so the kernel can back them with huge pages.
+
+  Usage example:
+
+    TableArena arena;
+    {
+      TableArena::Scope scope(arena);  // all tables built here pack together
+      auto L1 = factory.create("UniformExactInterpTable<3>", fc, par1);
+      auto L2 = factory.create("UniformExactInterpTable<3>", fc, par2);
+    }
+    // ... evaluate; destroy every arena-backed table before the arena
+
+  Notes:
+  - The arena must outlive every table allocated from it; table deleters run
+    element destructors but the memory is released wholesale by ~TableArena.
+  - allocate() is guarded by a critical section so parallel construction
+    (eg. CompositeLookupTable's ctor) is safe.
+  - Scopes restore the previously active arena, so they nest.
+*/
+#pragma once
+#include "MetaTable.hpp" // TableArenaBase
+#include <vector>
+#include <cstddef>
+
+#if defined(__unix__) || (defined(__APPLE__) && defined(__MACH__))
+#include <sys/mman.h> // mmap blocks, MADV_HUGEPAGE
+#endif
+
+namespace func {
+
+class TableArena final : public TableArenaBase
+{
+  struct Block {
+    void* base;
+    std::size_t size;
+    std::size_t used;
+  };
+  std::vector<Block> m_blocks;
+  std::size_t m_blockSize;
+  std::size_t m_totalRequested = 0;
+
+  static void* map_block(std::size_t bytes){
+#if defined(__unix__) || (defined(__APPLE__) && defined(__MACH__))
+    void* base = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(base == MAP_FAILED)
+      throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+    madvise(base, bytes, MADV_HUGEPAGE);
+#endif
+    return base;
+#else
+    return ::operator new(bytes);
+#endif
+  }
+
+  static void unmap_block(void* base, std::size_t bytes){
+#if defined(__unix__) || (defined(__APPLE__) && defined(__MACH__))
+    munmap(base, bytes);
+#else
+    (void) bytes;
+    ::operator delete(base);
+#endif
+  }
+
+public:
+  /** \brief blockSize is the granularity of the arena's mappings (oversized
+   * allocations get their own block) */
+  TableArena(std::size_t blockSize = 64u*1024u*1024u) : m_blockSize(blockSize) {}
+
+  ~TableArena(){
+    for(auto& b : m_blocks)
+      unmap_block(b.base, b.size);
+  }
+
+  /* owns raw blocks referenced by live tables: copying makes no sense */
+  TableArena(const TableArena&) = delete;
+  TableArena& operator=(const TableArena&) = delete;
+
+  void* allocate(std::size_t bytes, std::size_t alignment) final {
+    void* result = nullptr;
+    #pragma omp critical(func_table_arena)
+    {
+      m_totalRequested += bytes;
+      std::size_t aligned_used = m_blocks.empty() ? 0u :
+        ((m_blocks.back().used + alignment-1u) & ~(alignment-1u));
+      if(m_blocks.empty() || aligned_used + bytes > m_blocks.back().size){
+        std::size_t blockSize = bytes > m_blockSize ? bytes : m_blockSize;
+        m_blocks.push_back(Block{map_block(blockSize), blockSize, 0u});
+        aligned_used = 0u;
+      }
+      Block& b = m_blocks.back();
+      /* mmap'ed blocks are page aligned so aligning the offset suffices */
+      result = static_cast<char*>(b.base) + aligned_used;
+      b.used = aligned_used + bytes;
+    }
+    return result;
+  }
+
+  std::size_t num_blocks() const { return m_blocks.size(); }
+  std::size_t total_requested() const { return m_totalRequested; }
+
+  /** \brief RAII activation: while alive, every MetaTable built (by anything)
+   * allocates from this arena. Restores the previous arena so scopes nest. */
+  class Scope {
+    TableArenaBase* m_previous;
+  public:
+    Scope(TableArena& arena) : m_previous(TableArenaBase::active()) {
+      TableArenaBase::active() = &arena;
+    }
+    ~Scope(){
+      TableArenaBase::active() = m_previous;
+    }
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+  };
+};
+
+} // namespace func
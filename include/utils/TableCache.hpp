@@ -0,0 +1,125 @@
+/*
+  A process-wide cache of generated LookupTables plus advisory file locking
+  for generate_by_file workflows.
+
+  Motivation: every rank of an MPI job re-parses (or worse, regenerates and
+  rewrites) the same LUT files. The cache deduplicates within a process --
+  get_by_step returns one shared_ptr per distinct (table, bounds, step,
+  filename) -- and, when a filename is given, takes an advisory flock on
+  <filename>.lock so exactly one process generates while the others wait and
+  then load the finished file.
+
+  Usage example:
+
+    LookupTableGenerator<double> gen(fc, 0.0, 10.0);
+    auto L1 = TableCache<double>::instance().get_by_step(gen, "UniformExactInterpTable<3>", 1e-3, "t.json");
+    auto L2 = TableCache<double>::instance().get_by_step(gen, "UniformExactInterpTable<3>", 1e-3, "t.json");
+    // L1 == L2: built (or loaded) once
+
+  Notes:
+  - Tables are cached for the life of the process (clear() drops them).
+  - File locking is POSIX-only; elsewhere the cache still deduplicates
+    in-process and generation behaves like plain generate_by_step.
+  - The cache key includes the generator's bounds, so one cache instance can
+    serve generators over different domains.
+*/
+#pragma once
+#include "LookupTable.hpp"
+#include "LookupTableGenerator.hpp"
+#include <map>
+#include <memory>
+#include <string>
+#include <sstream>
+
+#if defined(__unix__) || (defined(__APPLE__) && defined(__MACH__))
+#define FUNC_USE_FLOCK
+#include <sys/file.h> // flock
+#include <fcntl.h>    // open
+#include <unistd.h>   // close
+#endif
+
+namespace func {
+
+template <typename TIN, typename TOUT = TIN>
+class TableCache
+{
+  std::map<std::string, std::shared_ptr<LookupTable<TIN,TOUT>>> m_cache;
+
+  static std::string make_key(const std::string& tableKey, TIN minArg, TIN maxArg, TIN stepSize, const std::string& filename){
+    std::ostringstream ss;
+    ss.precision(std::numeric_limits<TIN>::max_digits10);
+    ss << tableKey << "|" << minArg << "|" << maxArg << "|" << stepSize << "|" << filename;
+    return ss.str();
+  }
+
+public:
+  /** the process-wide cache (one per (TIN,TOUT) pair) */
+  static TableCache<TIN,TOUT>& instance(){
+    static TableCache<TIN,TOUT> cache;
+    return cache;
+  }
+
+  /** \brief generate_by_step through the cache.
+   *
+   * In-process: one shared table per distinct key. Across processes: when a
+   * filename is given, an advisory lock on <filename>.lock serializes the
+   * first generation so concurrent cold starts produce one generation plus
+   * fast loads instead of every process regenerating the same file. */
+  std::shared_ptr<LookupTable<TIN,TOUT>> get_by_step(LookupTableGenerator<TIN,TOUT>& gen,
+      const std::string& tableKey, TIN stepSize, const std::string& filename = "")
+  {
+    const std::string key = make_key(tableKey, gen.min_arg(), gen.max_arg(), stepSize, filename);
+
+    std::shared_ptr<LookupTable<TIN,TOUT>> lut;
+    #pragma omp critical(func_table_cache)
+    {
+      auto it = m_cache.find(key);
+      if(it != m_cache.end())
+        lut = it->second;
+    }
+    if(lut) return lut;
+
+#ifdef FUNC_USE_FLOCK
+    /* RAII so the lock is released even when generation throws. flock locks
+     * belong to the open file description, so a leaked fd would make this
+     * same process deadlock on its own stale lock at the next get_by_step */
+    struct FlockGuard {
+      int fd = -1;
+      FlockGuard(const std::string& lockname){
+        if(lockname == "") return;
+        fd = open(lockname.c_str(), O_CREAT | O_RDWR, 0666);
+        if(fd >= 0)
+          flock(fd, LOCK_EX); // wait here while another process generates
+      }
+      ~FlockGuard(){
+        if(fd >= 0){
+          flock(fd, LOCK_UN);
+          close(fd);
+        }
+      }
+    } lock(filename != "" ? filename + ".lock" : "");
+#endif
+    /* generate_by_step itself loads from filename when the file exists, so a
+     * process that waited on the lock simply loads the winner's output */
+    lut = gen.generate_by_step(tableKey, stepSize, filename);
+
+    #pragma omp critical(func_table_cache)
+    {
+      /* another thread may have raced us here; keep the first entry */
+      auto it = m_cache.find(key);
+      if(it != m_cache.end())
+        lut = it->second;
+      else
+        m_cache.insert({key, lut});
+    }
+    return lut;
+  }
+
+  std::size_t size() const { return m_cache.size(); }
+  void clear(){
+    #pragma omp critical(func_table_cache)
+    m_cache.clear();
+  }
+};
+
+} // namespace func
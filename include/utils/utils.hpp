@@ -2,11 +2,16 @@
 #include "LookupTableFactory.hpp"
 #include "ArgumentRecord.hpp"
 #include "CompositeLookupTable.hpp"
+#include "DeviceEvaluation.hpp"
 #include "DirectEvaluation.hpp"
 #include "FailureProofTable.hpp"
 #include "LookupTableComparator.hpp"
 #include "LookupTableGenerator.hpp"
+#include "NumaReplicatedTable.hpp"
 #include "RngInterface.hpp"
+#include "StaticDispatchTable.hpp"
 #include "StdRng.hpp"
+#include "TableArena.hpp"
+#include "TableCache.hpp"
 #include "Timer.hpp"
 #include "cxx17utils.hpp"